@@ -0,0 +1,172 @@
+#include "ansidecoder.h"
+
+constexpr ushort ESC = 0x1b;
+
+void AnsiDecoder::reset()
+{
+    style_ = 0;
+}
+
+QString AnsiDecoder::decode(const QString& line, QVector<StyleRun>& runs)
+{
+    runs.clear();
+    int esc = line.indexOf(QChar(ESC));
+    if (esc < 0) {
+        // 绝大多数行没有转义序列
+        if (style_ != 0) {
+            runs.append({0, style_});
+        }
+        return line;
+    }
+
+    QString text;
+    text.reserve(line.size());
+    mark(0, runs);
+
+    const int size = line.size();
+    int i = 0;
+    while (i < size) {
+        if (line.at(i).unicode() != ESC) {
+            int next = line.indexOf(QChar(ESC), i);
+            if (next < 0) {
+                next = size;
+            }
+            text.append(line.constData() + i, next - i);
+            i = next;
+            continue;
+        }
+
+        if (i + 1 >= size) {
+            break;
+        }
+        ushort kind = line.at(i + 1).unicode();
+        if (kind == '[') {
+            // CSI：参数字节 0x30-0x3F，中间字节 0x20-0x2F，结束字节 0x40-0x7E
+            int j = i + 2;
+            QVector<int> params;
+            int value = -1;
+            while (j < size) {
+                ushort c = line.at(j).unicode();
+                if (c >= '0' && c <= '9') {
+                    value = (value < 0 ? 0 : value * 10) + (c - '0');
+                } else if (c == ';' || c == ':') {
+                    params.append(value < 0 ? 0 : value);
+                    value = -1;
+                } else if (c >= 0x40 && c <= 0x7e) {
+                    break;
+                } else if (c < 0x20 || c > 0x3f) {
+                    break;
+                }
+                ++j;
+            }
+            if (j < size && line.at(j).unicode() == 'm') {
+                params.append(value < 0 ? 0 : value);
+                applySgr(params);
+                mark(text.size(), runs);
+            }
+            i = j + 1;
+        } else if (kind == ']') {
+            // OSC（如终端标题、超链接），以 BEL 或 ESC\ 结束
+            int j = i + 2;
+            while (j < size && line.at(j).unicode() != 0x07 &&
+                   !(line.at(j).unicode() == ESC && j + 1 < size && line.at(j + 1) == '\\')) {
+                ++j;
+            }
+            i = (j < size && line.at(j).unicode() == ESC) ? j + 2 : j + 1;
+        } else {
+            i += 2;
+        }
+    }
+
+    // 分行时已去掉行尾空白，这里去掉转义序列之后才露出来的部分
+    int end = text.size();
+    while (end > 0 && (text.at(end - 1) == ' ' || text.at(end - 1) == '\t')) {
+        --end;
+    }
+    text.truncate(end);
+    while (!runs.isEmpty() && runs.last().start >= end) {
+        runs.removeLast();
+    }
+    if (!runs.isEmpty() && runs.first().style == 0) {
+        // 行首的默认样式段不必保存
+        runs.removeFirst();
+    }
+    return text;
+}
+
+void AnsiDecoder::mark(int pos, QVector<StyleRun>& runs) const
+{
+    if (!runs.isEmpty() && runs.last().start == pos) {
+        runs.last().style = style_;
+        if (runs.size() > 1 && runs.at(runs.size() - 2).style == style_) {
+            runs.removeLast();
+        }
+        return;
+    }
+    quint32 current = runs.isEmpty() ? 0 : runs.last().style;
+    if (current != style_) {
+        runs.append({pos, style_});
+    }
+}
+
+void AnsiDecoder::applySgr(const QVector<int>& params)
+{
+    using namespace AnsiStyle;
+    for (int i = 0; i < params.size(); ++i) {
+        int p = params.at(i);
+        if (p == 0) {
+            style_ = 0;
+        } else if (p == 1) {
+            style_ |= Bold;
+        } else if (p == 2) {
+            style_ |= Faint;
+        } else if (p == 3) {
+            style_ |= Italic;
+        } else if (p == 4) {
+            style_ |= Underline;
+        } else if (p == 7) {
+            style_ |= Inverse;
+        } else if (p == 22) {
+            style_ &= ~(Bold | Faint);
+        } else if (p == 23) {
+            style_ &= ~Italic;
+        } else if (p == 24) {
+            style_ &= ~Underline;
+        } else if (p == 27) {
+            style_ &= ~Inverse;
+        } else if ((p >= 30 && p <= 37) || (p >= 90 && p <= 97)) {
+            int index = p >= 90 ? p - 90 + 8 : p - 30;
+            style_ = (style_ & ~FgMask) | HasFg | static_cast<quint32>(index);
+        } else if (p == 39) {
+            style_ &= ~(FgMask | HasFg);
+        } else if ((p >= 40 && p <= 47) || (p >= 100 && p <= 107)) {
+            int index = p >= 100 ? p - 100 + 8 : p - 40;
+            style_ = (style_ & ~BgMask) | HasBg | static_cast<quint32>(index) << BgShift;
+        } else if (p == 49) {
+            style_ &= ~(BgMask | HasBg);
+        } else if (p == 38 || p == 48) {
+            // 扩展颜色：38;5;n 为 256 色，38;2;r;g;b 为真彩色（映射到最接近的 256 色）
+            int index = -1;
+            if (i + 2 < params.size() && params.at(i + 1) == 5) {
+                index = params.at(i + 2) & 0xff;
+                i += 2;
+            } else if (i + 4 < params.size() && params.at(i + 1) == 2) {
+                index = rgbToIndex(params.at(i + 2), params.at(i + 3), params.at(i + 4));
+                i += 4;
+            } else {
+                break;
+            }
+            if (p == 38) {
+                style_ = (style_ & ~FgMask) | HasFg | static_cast<quint32>(index);
+            } else {
+                style_ = (style_ & ~BgMask) | HasBg | static_cast<quint32>(index) << BgShift;
+            }
+        }
+    }
+}
+
+int AnsiDecoder::rgbToIndex(int r, int g, int b)
+{
+    auto level = [](int v) { return v < 48 ? 0 : (v < 115 ? 1 : qMin(5, (v - 35) / 40)); };
+    return 16 + 36 * level(r) + 6 * level(g) + level(b);
+}
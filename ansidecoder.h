@@ -0,0 +1,48 @@
+#ifndef ANSIDECODER_H
+#define ANSIDECODER_H
+
+#include <QString>
+#include <QVector>
+
+// 一段样式：从纯文本下标 start 开始，到下一段开始（或行尾）为止
+struct StyleRun {
+    int start{};
+    quint32 style{};
+};
+
+// 样式按位压缩在一个 quint32 中，0 表示默认样式
+namespace AnsiStyle {
+enum : quint32 {
+    FgMask = 0x000000FF,   // 前景色，256 色调色板下标
+    BgMask = 0x0000FF00,   // 背景色，256 色调色板下标
+    BgShift = 8,
+    HasFg = 1u << 24,
+    HasBg = 1u << 25,
+    Bold = 1u << 26,
+    Faint = 1u << 27,
+    Italic = 1u << 28,
+    Underline = 1u << 29,
+    Inverse = 1u << 30,
+};
+}
+
+// 流式 ANSI 转义序列解码器，每个输出通道一个实例。
+// SGR（ESC[...m）转换为样式段，其余 CSI/OSC 序列直接丢弃；
+// 样式状态跨行保持，与终端行为一致。
+class AnsiDecoder
+{
+public:
+    void reset();
+    // 返回去掉转义序列后的文本，runs 为该行的样式段（无样式时为空）
+    QString decode(const QString& line, QVector<StyleRun>& runs);
+
+private:
+    void applySgr(const QVector<int>& params);
+    void mark(int pos, QVector<StyleRun>& runs) const;
+    static int rgbToIndex(int r, int g, int b);
+
+private:
+    quint32 style_{};
+};
+
+#endif
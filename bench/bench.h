@@ -0,0 +1,19 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <QString>
+#include <QStringList>
+
+// 合成的构建输出：ninja 状态行与编译器诊断交替出现
+QStringList syntheticLines(int count);
+
+// 旧的逐行 QPlainTextEdit 插入与 LogSink 批量刷新的吞吐对比
+void runLogSinkBench(int lines);
+
+// 改动前按 left()/mid() 分行与 LineSplitter 的对比，按不同的单次读取大小分别计时
+void runSplitterBench(int lines);
+
+// 每行输出一个结果，列对齐
+void printResult(const QString& name, int lines, qint64 ns);
+
+#endif
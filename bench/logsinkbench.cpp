@@ -0,0 +1,93 @@
+#include <QApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QPlainTextEdit>
+#include <QScrollBar>
+#include <QTextCursor>
+
+#include "bench.h"
+#include "logsink.h"
+#include "logstore.h"
+#include "logview.h"
+
+namespace {
+
+// 两条路径都按帧处理事件，模拟界面线程在两次读取之间回到事件循环
+constexpr qint64 FRAME_NS = 16 * 1000 * 1000;
+
+// 改动前 CmakeBuilder::Print 的实现：每行构造时间戳和两个格式，逐段插入并移动滚动条
+void legacyPrint(QPlainTextEdit* edit, const QString& text)
+{
+    QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss.zzz");
+
+    QTextCursor cursor = edit->textCursor();
+    cursor.movePosition(QTextCursor::End);
+
+    QTextCharFormat timeFormat;
+    timeFormat.setForeground(QBrush(QColor(128, 128, 128)));
+    timeFormat.setFontWeight(QFont::Normal);
+    cursor.setCharFormat(timeFormat);
+    cursor.insertText("[" + timestamp + "] ");
+
+    QTextCharFormat contentFormat;
+    contentFormat.setForeground(QBrush(QColor(0, 0, 0)));
+    contentFormat.setFontWeight(QFont::Normal);
+    cursor.setCharFormat(contentFormat);
+    cursor.insertText(text + "\n");
+
+    QScrollBar* vScrollBar = edit->verticalScrollBar();
+    vScrollBar->setValue(vScrollBar->maximum());
+}
+
+qint64 runLegacy(const QStringList& lines)
+{
+    QPlainTextEdit edit;
+    edit.resize(1000, 700);
+    edit.show();
+    QApplication::processEvents();
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 frame = 0;
+    for (const QString& line : lines) {
+        legacyPrint(&edit, line);
+        if (timer.nsecsElapsed() - frame >= FRAME_NS) {
+            QApplication::processEvents();
+            frame = timer.nsecsElapsed();
+        }
+    }
+    QApplication::processEvents();
+    return timer.nsecsElapsed();
+}
+
+qint64 runSink(const QStringList& lines)
+{
+    LogView view;
+    view.resize(1000, 700);
+    view.show();
+    LogSink sink(&view);
+    QApplication::processEvents();
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 frame = 0;
+    for (const QString& line : lines) {
+        sink.append(line);
+        if (timer.nsecsElapsed() - frame >= FRAME_NS) {
+            QApplication::processEvents();
+            frame = timer.nsecsElapsed();
+        }
+    }
+    sink.flush();
+    QApplication::processEvents();
+    return timer.nsecsElapsed();
+}
+
+}   // namespace
+
+void runLogSinkBench(int count)
+{
+    QStringList lines = syntheticLines(count);
+    printResult("Print -> QPlainTextEdit（逐行）", count, runLegacy(lines));
+    printResult("LogSink -> LogView（按帧批量）", count, runSink(lines));
+}
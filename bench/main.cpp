@@ -0,0 +1,83 @@
+#include <QApplication>
+#include <cstdio>
+
+#include "bench.h"
+
+namespace {
+
+void writeLine(const QString& text, bool isError = false)
+{
+    FILE* out = isError ? stderr : stdout;
+    QByteArray data = text.toLocal8Bit();
+    data += '\n';
+    fwrite(data.constData(), 1, static_cast<size_t>(data.size()), out);
+    fflush(out);
+}
+
+}   // namespace
+
+// 用法：cmakeBuilderBench [sink] [split] [行数]，不指定时全部运行
+// 界面相关的基准需要窗口系统，无显示环境时可设置 QT_QPA_PLATFORM=offscreen
+int main(int argc, char* argv[])
+{
+    QApplication a(argc, argv);
+
+    QStringList args = a.arguments().mid(1);
+    int lines = 20000;
+    QStringList names;
+    for (const QString& arg : args) {
+        bool ok = false;
+        int n = arg.toInt(&ok);
+        if (ok && n > 0) {
+            lines = n;
+        } else {
+            names << arg;
+        }
+    }
+    if (names.isEmpty()) {
+        names << "sink" << "split";
+    }
+
+    for (const QString& name : names) {
+        if (name == "sink") {
+            runLogSinkBench(lines);
+        } else if (name == "split") {
+            runSplitterBench(lines);
+        } else {
+            writeLine("未知的基准: " + name, true);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+QStringList syntheticLines(int count)
+{
+    QStringList lines;
+    lines.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        if (i % 10 == 9) {
+            lines << QString("/home/user/project/src/module%1/widget%2.cpp:%3:17: warning: unused variable 'value%4' "
+                             "[-Wunused-variable]")
+                         .arg(i % 37)
+                         .arg(i % 101)
+                         .arg(i % 400 + 1)
+                         .arg(i);
+        } else {
+            lines << QString("[%1/%2] Building CXX object src/module%3/CMakeFiles/module%3.dir/widget%4.cpp.o")
+                         .arg(i + 1)
+                         .arg(count)
+                         .arg(i % 37)
+                         .arg(i % 101);
+        }
+    }
+    return lines;
+}
+
+void printResult(const QString& name, int lines, qint64 ns)
+{
+    double seconds = ns / 1e9;
+    writeLine(name.leftJustified(36) + QString::number(lines).rightJustified(9) + " 行  " +
+              QString::number(seconds * 1000, 'f', 1).rightJustified(10) + " ms  " +
+              QString::number(seconds > 0 ? lines / seconds : 0, 'f', 0).rightJustified(12) + " 行/秒");
+}
@@ -0,0 +1,68 @@
+#include <QElapsedTimer>
+
+#include "bench.h"
+#include "linesplitter.h"
+
+namespace {
+
+// 改动前 onProcessReadyRead 的分行方式：每次读取整体解码后追加到缓冲区，
+// 每取出一行都用 mid() 复制剩余部分，单次读取内的行数越多越慢
+int legacySplit(const QByteArray& data, QString& buffer)
+{
+    int count = 0;
+    buffer.append(QString::fromLocal8Bit(data));
+    int newlinePos;
+    while ((newlinePos = buffer.indexOf('\n')) != -1) {
+        QString line = buffer.left(newlinePos).trimmed();
+        buffer = buffer.mid(newlinePos + 1);
+        if (!line.isEmpty()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+QVector<QByteArray> makeChunks(const QByteArray& data, int chunkSize)
+{
+    QVector<QByteArray> chunks;
+    for (int i = 0; i < data.size(); i += chunkSize) {
+        chunks << data.mid(i, chunkSize);
+    }
+    return chunks;
+}
+
+}   // namespace
+
+void runSplitterBench(int count)
+{
+    QByteArray data = syntheticLines(count).join('\n').toUtf8();
+    data += '\n';
+
+    // 管道单次读取的典型大小从 4 KB 到一次读完
+    for (int chunkSize : {4 * 1024, 64 * 1024, 1024 * 1024}) {
+        QVector<QByteArray> chunks = makeChunks(data, chunkSize);
+        QString suffix = QString("（每次 %1 KB）").arg(chunkSize / 1024);
+
+        QElapsedTimer timer;
+        timer.start();
+        QString buffer;
+        int legacyLines = 0;
+        for (const QByteArray& chunk : chunks) {
+            legacyLines += legacySplit(chunk, buffer);
+        }
+        printResult("left()/mid() 分行" + suffix, legacyLines, timer.nsecsElapsed());
+
+        timer.restart();
+        LineSplitter splitter;
+        QStringList lines;
+        int splitLines = 0;
+        for (const QByteArray& chunk : chunks) {
+            splitter.feed(chunk, lines);
+            splitLines += lines.size();
+            lines.clear();
+        }
+        splitter.finish(lines);
+        splitLines += lines.size();
+        printResult("LineSplitter" + suffix, splitLines, timer.nsecsElapsed());
+    }
+}
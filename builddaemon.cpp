@@ -0,0 +1,374 @@
+#include "builddaemon.h"
+
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTimer>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+#include "cmakeargs.h"
+#include "config.h"
+#include "jobqueue.h"
+#include "processrunner.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+QByteArray toLine(const json& j)
+{
+    QByteArray data = QByteArray::fromStdString(j.dump());
+    data += '\n';
+    return data;
+}
+
+json jobEvent(const char* event, int id)
+{
+    json j;
+    j["event"] = event;
+    j["job"] = id;
+    return j;
+}
+
+}   // namespace
+
+BuildDaemon::BuildDaemon(BuilderConfig* config, QObject* parent) : QObject(parent), config_(config)
+{
+    server_ = new QLocalServer(this);
+    // 只允许当前用户连接
+    server_->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(server_, &QLocalServer::newConnection, this, &BuildDaemon::onConnection);
+
+    jobs_ = new JobQueue(this);
+    connect(jobs_, &JobQueue::sigJobAdded, this, [this](int id) {
+        if (submitter_) {
+            owners_.insert(id, submitter_);
+        }
+    });
+    connect(jobs_, &JobQueue::sigJobChanged, this, &BuildDaemon::onJobChanged);
+    connect(jobs_, &JobQueue::sigJobOutput, this, &BuildDaemon::onJobOutput);
+    connect(jobs_, &JobQueue::sigJobProgress, this, &BuildDaemon::onJobProgress);
+}
+
+BuildDaemon::~BuildDaemon()
+{
+}
+
+bool BuildDaemon::listen(const QString& name, QString& error)
+{
+    // 能连上说明已有守护进程在运行；连不上的残留套接字文件可以删除
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(200)) {
+        error = "已有守护进程在监听 " + name;
+        return false;
+    }
+    QLocalServer::removeServer(name);
+
+    if (!server_->listen(name)) {
+        error = server_->errorString();
+        return false;
+    }
+    return true;
+}
+
+void BuildDaemon::setCoreBudget(int cores)
+{
+    jobs_->setCoreBudget(cores);
+}
+
+void BuildDaemon::onConnection()
+{
+    while (QLocalSocket* socket = server_->nextPendingConnection()) {
+        clients_.insert(socket, Client());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() { onDisconnected(socket); });
+    }
+}
+
+void BuildDaemon::onReadyRead(QLocalSocket* socket)
+{
+    auto it = clients_.find(socket);
+    if (it == clients_.end()) {
+        return;
+    }
+    it->buffer += socket->readAll();
+
+    int pos = 0;
+    int nl = 0;
+    QList<QByteArray> lines;
+    while ((nl = it->buffer.indexOf('\n', pos)) >= 0) {
+        QByteArray line = it->buffer.mid(pos, nl - pos).trimmed();
+        if (!line.isEmpty()) {
+            lines << line;
+        }
+        pos = nl + 1;
+    }
+    it->buffer.remove(0, pos);
+
+    // 处理请求期间可能发出事件，不能持有 clients_ 的迭代器
+    for (const QByteArray& line : lines) {
+        handle(socket, line);
+    }
+}
+
+void BuildDaemon::onDisconnected(QLocalSocket* socket)
+{
+    // 断开的客户端提交的任务继续运行，只是不再推送给它
+    clients_.remove(socket);
+    for (auto it = owners_.begin(); it != owners_.end();) {
+        if (it.value() == socket) {
+            it = owners_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    socket->deleteLater();
+}
+
+void BuildDaemon::handle(QLocalSocket* socket, const QByteArray& line)
+{
+    json reply;
+    reply["event"] = "reply";
+
+    json req;
+    try {
+        req = json::parse(line.constData(), line.constData() + line.size());
+    } catch (const std::exception& e) {
+        reply["event"] = "error";
+        reply["message"] = std::string("无效的 JSON: ") + e.what();
+        send(socket, toLine(reply));
+        return;
+    }
+    if (!req.is_object()) {
+        reply["event"] = "error";
+        reply["message"] = "请求必须是 JSON 对象";
+        send(socket, toLine(reply));
+        return;
+    }
+    if (req.contains("req")) {
+        reply["req"] = req["req"];
+    }
+
+    bool suspended = false;
+    try {
+        std::string cmd = req.value("cmd", "");
+        reply["cmd"] = cmd;
+
+        if (cmd == "configure" || cmd == "build" || cmd == "run" || cmd == "chain") {
+            QString project = QString::fromStdString(req.value("project", ""));
+            OneConfig o;
+            if (project.isEmpty() || !config_->GetData(project, o)) {
+                throw std::runtime_error("未找到项目配置: " + project.toStdString());
+            }
+            if (req.contains("mode")) {
+                o.curMode = QString::fromStdString(req["mode"].get<std::string>());
+            }
+            if (req.contains("target")) {
+                o.curTarget = QString::fromStdString(req["target"].get<std::string>());
+            }
+            if (req.contains("generator")) {
+                o.curType = QString::fromStdString(req["generator"].get<std::string>());
+            }
+
+            // 提交者在 sigJobAdded 中登记为任务的所有者；回复发出之前暂停调度，
+            // 否则任务可能在 add 中就开始甚至结束（跳过的配置），事件先于告知任务 id 的回复到达
+            QList<int> ids;
+            submitter_ = socket;
+            jobs_->suspend();
+            suspended = true;
+            if (cmd == "chain") {
+                ids = jobs_->addChain(o, req.value("run", false));
+            } else {
+                Job::Kind kind = cmd == "configure" ? Job::Configure : (cmd == "build" ? Job::Build : Job::Run);
+                ids << jobs_->add(kind, o);
+            }
+            submitter_ = nullptr;
+            json array = json::array();
+            for (int id : ids) {
+                array.push_back(id);
+            }
+            reply["jobs"] = array;
+        } else if (cmd == "cancel") {
+            if (req.contains("job")) {
+                jobs_->cancel(req["job"].get<int>());
+            } else {
+                jobs_->cancelAll();
+            }
+        } else if (cmd == "subscribe") {
+            Client& client = clients_[socket];
+            client.subscribed = true;
+            client.output = req.value("output", true);
+        } else if (cmd == "projects") {
+            QVector<QString> keys;
+            config_->GetAllKeys(keys);
+            json array = json::array();
+            for (const QString& key : keys) {
+                array.push_back(key.toStdString());
+            }
+            reply["projects"] = array;
+        } else if (cmd == "targets") {
+            QString project = QString::fromStdString(req.value("project", ""));
+            OneConfig o;
+            if (project.isEmpty() || !config_->GetData(project, o)) {
+                throw std::runtime_error("未找到项目配置: " + project.toStdString());
+            }
+            QString mode = QString::fromStdString(req.value("mode", o.curMode.toStdString()));
+            if (mode.isEmpty()) {
+                mode = "Debug";
+            }
+            QString generator = QString::fromStdString(req.value("generator", o.curType.toStdString()));
+            json array = json::array();
+            for (const QString& target : targets(CMakeArgs::ninjaFile(o.buildDir, generator, mode))) {
+                array.push_back(target.toStdString());
+            }
+            reply["targets"] = array;
+        } else if (cmd == "status") {
+            json array = json::array();
+            for (int id : jobs_->ids()) {
+                const Job* job = jobs_->job(id);
+                json j;
+                j["job"] = id;
+                j["project"] = job->config.key.toStdString();
+                j["kind"] = JobQueue::kindName(job->kind).toStdString();
+                j["state"] = JobQueue::stateName(job->state).toStdString();
+                j["command"] = job->command.toStdString();
+                array.push_back(j);
+            }
+            reply["jobs"] = array;
+        } else {
+            throw std::runtime_error("未知命令: " + cmd);
+        }
+    } catch (const std::exception& e) {
+        reply["event"] = "error";
+        reply["message"] = e.what();
+    }
+    send(socket, toLine(reply));
+    if (suspended) {
+        jobs_->resume();
+    }
+}
+
+void BuildDaemon::onJobChanged(int id)
+{
+    const Job* job = jobs_->job(id);
+    if (!job) {
+        return;
+    }
+
+    json j = jobEvent("state", id);
+    j["project"] = job->config.key.toStdString();
+    j["kind"] = JobQueue::kindName(job->kind).toStdString();
+    j["mode"] = job->mode.toStdString();
+    j["state"] = JobQueue::stateName(job->state).toStdString();
+    if (!job->command.isEmpty()) {
+        j["command"] = job->command.toStdString();
+    }
+    if (!job->note.isEmpty()) {
+        j["note"] = job->note.toStdString();
+    }
+    publish(id, toLine(j));
+
+    if (!job->isDone()) {
+        return;
+    }
+    // 读取剩余的输出
+    onJobOutput(id);
+    json exit = jobEvent("exit", id);
+    exit["state"] = JobQueue::stateName(job->state).toStdString();
+    exit["success"] = job->state == Job::Succeeded;
+    exit["exitCode"] = job->exitCode;
+    exit["elapsedMs"] = job->elapsedMs;
+    if (!job->error.isEmpty()) {
+        exit["error"] = job->error.toStdString();
+    }
+    publish(id, toLine(exit));
+
+    // 等本轮调度（跳过失败任务的后续任务）完成后再释放任务和它的 I/O 线程
+    QTimer::singleShot(0, this, [this, id]() {
+        jobs_->remove(id);
+        owners_.remove(id);
+    });
+}
+
+void BuildDaemon::onJobOutput(int id)
+{
+    ProcessRunner* runner = jobs_->runner(id);
+    if (!runner) {
+        return;
+    }
+
+    QVector<OutputLine> lines;
+    runner->takeLines(lines);
+    for (const OutputLine& line : lines) {
+        if (line.hidden) {
+            continue;
+        }
+        json j = jobEvent("output", id);
+        j["text"] = line.text.toStdString();
+        j["error"] = line.isError;
+        publish(id, toLine(j), true);
+
+        const Diagnostic& diag = line.diag;
+        if (diag.severity != Diagnostic::None) {
+            json d = jobEvent("diagnostic", id);
+            d["severity"] = DiagnosticParser::severityName(diag.severity).toStdString();
+            d["file"] = diag.file.toStdString();
+            d["line"] = diag.line;
+            d["column"] = diag.column;
+            d["code"] = diag.code.toStdString();
+            d["message"] = diag.message.toStdString();
+            publish(id, toLine(d));
+        }
+    }
+}
+
+void BuildDaemon::onJobProgress(int id)
+{
+    ProcessRunner* runner = jobs_->runner(id);
+    if (!runner) {
+        return;
+    }
+
+    NinjaProgress p = runner->takeProgress();
+    json j = jobEvent("progress", id);
+    j["finished"] = p.finished;
+    j["total"] = p.total;
+    j["running"] = p.running;
+    j["elapsed"] = p.elapsed;
+    publish(id, toLine(j));
+}
+
+void BuildDaemon::publish(int id, const QByteArray& event, bool isOutput)
+{
+    QLocalSocket* owner = owners_.value(id);
+    if (owner) {
+        send(owner, event);
+    }
+    for (auto it = clients_.constBegin(); it != clients_.constEnd(); ++it) {
+        if (it.key() != owner && it->subscribed && (!isOutput || it->output)) {
+            send(it.key(), event);
+        }
+    }
+}
+
+void BuildDaemon::send(QLocalSocket* socket, const QByteArray& event)
+{
+    if (socket->state() == QLocalSocket::ConnectedState) {
+        socket->write(event);
+    }
+}
+
+QStringList BuildDaemon::targets(const QString& ninjaFile)
+{
+    // 目标列表按 ninja 文件的修改时间缓存，重新配置后才重新解析
+    QDateTime modified = QFileInfo(ninjaFile).lastModified();
+    auto it = targets_.constFind(ninjaFile);
+    if (it != targets_.constEnd() && it->modified == modified) {
+        return it->targets;
+    }
+    QStringList list = CMakeArgs::readTargets(ninjaFile);
+    targets_.insert(ninjaFile, TargetCache{modified, list});
+    return list;
+}
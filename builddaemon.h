@@ -0,0 +1,72 @@
+#ifndef BUILDDAEMON_H
+#define BUILDDAEMON_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+class BuilderConfig;
+class JobQueue;
+
+// 本地构建守护进程：在 QLocalServer 上接收 JSON 行请求，对保存的项目执行
+// 配置/构建/运行/取消，并把任务事件（状态、输出、进度、诊断、退出）以 JSON 行推送给
+// 提交者和订阅者。进程常驻，VC 环境、配置指纹和目标列表在请求之间保持有效。
+//
+// 请求（每行一个 JSON 对象，可带 "req" 字段，原样出现在回复中）：
+//   {"cmd":"build","project":"X","mode":"Release","target":"Y"}   configure/build/run 同理
+//   {"cmd":"chain","project":"X","run":true}                      配置 -> 构建 [-> 运行]
+//   {"cmd":"cancel","job":3}    {"cmd":"cancel"} 取消全部
+//   {"cmd":"subscribe","output":false}                            接收所有任务的事件
+//   {"cmd":"projects"}  {"cmd":"targets","project":"X"}  {"cmd":"status"}
+// 事件：{"event":"state"|"output"|"progress"|"diagnostic"|"exit"|"reply"|"error", "job":id, ...}
+class BuildDaemon : public QObject
+{
+    Q_OBJECT
+
+public:
+    BuildDaemon(BuilderConfig* config, QObject* parent = nullptr);
+    ~BuildDaemon();
+
+public:
+    bool listen(const QString& name, QString& error);
+    void setCoreBudget(int cores);
+
+private:
+    struct Client {
+        QByteArray buffer;
+        bool subscribed{};
+        bool output{true};   // 订阅者是否接收输出行
+    };
+
+    struct TargetCache {
+        QDateTime modified;
+        QStringList targets;
+    };
+
+    void onConnection();
+    void onReadyRead(QLocalSocket* socket);
+    void onDisconnected(QLocalSocket* socket);
+    void handle(QLocalSocket* socket, const QByteArray& line);
+    void onJobChanged(int id);
+    void onJobOutput(int id);
+    void onJobProgress(int id);
+    // 发给任务的提交者和订阅者；isOutput 的事件只发给要求输出的订阅者
+    void publish(int id, const QByteArray& event, bool isOutput = false);
+    void send(QLocalSocket* socket, const QByteArray& event);
+    QStringList targets(const QString& ninjaFile);
+
+private:
+    BuilderConfig* config_{};
+    QLocalServer* server_{};
+    JobQueue* jobs_{};
+    QHash<QLocalSocket*, Client> clients_;
+    QHash<int, QLocalSocket*> owners_;
+    QLocalSocket* submitter_{};
+    QHash<QString, TargetCache> targets_;
+};
+
+#endif
@@ -0,0 +1,282 @@
+#include "buildhistory.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QUrl>
+#include <algorithm>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr auto INDEX_SUFFIX = ".jsonl";
+constexpr auto EDGES_SUFFIX = ".edges";
+// 概要中保存的最慢边数
+constexpr int SLOWEST_KEPT = 5;
+// 超过基线 15% 视为回归
+constexpr double REGRESSION_RATIO = 1.15;
+
+json toJson(const HistoryRecord& r)
+{
+    json j;
+    j["time"] = r.time;
+    j["kind"] = r.kind.toStdString();
+    j["project"] = r.project.toStdString();
+    j["mode"] = r.mode.toStdString();
+    j["target"] = r.target.toStdString();
+    j["generator"] = r.generator.toStdString();
+    j["commit"] = r.commit.toStdString();
+    j["exit"] = r.exitCode;
+    j["ok"] = r.success;
+    j["wall"] = r.wallMs;
+    j["cpu"] = r.cpuMs;
+    j["edges"] = r.edges;
+    j["par"] = r.parallelism;
+    j["crit"] = r.criticalMs;
+    json slowest = json::array();
+    for (const auto& s : r.slowest) {
+        slowest.push_back(json::array({s.first.toStdString(), s.second}));
+    }
+    j["slow"] = slowest;
+    if (r.edgesOffset >= 0) {
+        j["eo"] = r.edgesOffset;
+        j["es"] = r.edgesSize;
+    }
+    return j;
+}
+
+HistoryRecord fromJson(const json& j)
+{
+    HistoryRecord r;
+    r.time = j.value("time", static_cast<qint64>(0));
+    r.kind = QString::fromStdString(j.value("kind", ""));
+    r.project = QString::fromStdString(j.value("project", ""));
+    r.mode = QString::fromStdString(j.value("mode", ""));
+    r.target = QString::fromStdString(j.value("target", ""));
+    r.generator = QString::fromStdString(j.value("generator", ""));
+    r.commit = QString::fromStdString(j.value("commit", ""));
+    r.exitCode = j.value("exit", 0);
+    r.success = j.value("ok", false);
+    r.wallMs = j.value("wall", static_cast<qint64>(0));
+    r.cpuMs = j.value("cpu", static_cast<qint64>(0));
+    r.edges = j.value("edges", 0);
+    r.parallelism = j.value("par", 0.0);
+    r.criticalMs = j.value("crit", static_cast<qint64>(0));
+    if (j.contains("slow") && j["slow"].is_array()) {
+        for (const auto& s : j["slow"]) {
+            if (s.is_array() && s.size() == 2) {
+                r.slowest.append(qMakePair(QString::fromStdString(s[0].get<std::string>()), s[1].get<qint64>()));
+            }
+        }
+    }
+    r.edgesOffset = j.value("eo", static_cast<qint64>(-1));
+    r.edgesSize = j.value("es", 0);
+    return r;
+}
+
+}   // namespace
+
+QString HistoryRecord::key() const
+{
+    return project + "|" + mode + "|" + target + "|" + kind;
+}
+
+BuildHistory::BuildHistory(const QString& dir) : dir_(dir)
+{
+}
+
+QString BuildHistory::basePath(const QString& project) const
+{
+    // 项目名可能含有不能用作文件名的字符
+    QString name = project.isEmpty() ? QString("default") : QString::fromLatin1(QUrl::toPercentEncoding(project));
+    return dir_ + "/" + name;
+}
+
+bool BuildHistory::append(const HistoryRecord& record, const QVector<NinjaEdge>& edges, QString& error)
+{
+    if (!QDir().mkpath(dir_)) {
+        error = "无法创建目录 " + dir_;
+        return false;
+    }
+
+    HistoryRecord r = record;
+    QVector<NinjaEdge> sorted = edges;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const NinjaEdge& a, const NinjaEdge& b) { return a.duration() > b.duration(); });
+    r.slowest.clear();
+    for (int i = 0; i < sorted.size() && i < SLOWEST_KEPT; ++i) {
+        r.slowest.append(qMakePair(sorted.at(i).outputs.first(), sorted.at(i).duration()));
+    }
+
+    QString base = basePath(record.project);
+    if (!edges.isEmpty()) {
+        QByteArray text;
+        for (const NinjaEdge& edge : edges) {
+            text += edge.outputs.first().toUtf8() + '\t' + QByteArray::number(edge.duration()) + '\n';
+        }
+        QByteArray blob = qCompress(text);
+        QFile file(base + EDGES_SUFFIX);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            error = file.errorString();
+            return false;
+        }
+        r.edgesOffset = file.size();
+        r.edgesSize = blob.size();
+        if (file.write(blob) != blob.size()) {
+            error = file.errorString();
+            return false;
+        }
+    }
+
+    QFile index(base + INDEX_SUFFIX);
+    if (!index.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        error = index.errorString();
+        return false;
+    }
+    QByteArray line = QByteArray::fromStdString(toJson(r).dump()) + '\n';
+    if (index.write(line) != line.size()) {
+        error = index.errorString();
+        return false;
+    }
+    return true;
+}
+
+QVector<HistoryRecord> BuildHistory::load(const QString& project) const
+{
+    QVector<HistoryRecord> records;
+    QFile file(basePath(project) + INDEX_SUFFIX);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return records;
+    }
+    // 写入中断留下的半行直接跳过
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        try {
+            records.append(fromJson(json::parse(line.constData(), line.constData() + line.size())));
+        } catch (const std::exception&) {
+            continue;
+        }
+    }
+    return records;
+}
+
+QStringList BuildHistory::projects() const
+{
+    QStringList result;
+    QDir dir(dir_);
+    for (const QString& name : dir.entryList(QStringList{QString("*") + INDEX_SUFFIX}, QDir::Files, QDir::Name)) {
+        QString encoded = name.left(name.size() - static_cast<int>(qstrlen(INDEX_SUFFIX)));
+        result << QUrl::fromPercentEncoding(encoded.toLatin1());
+    }
+    return result;
+}
+
+QHash<QString, qint64> BuildHistory::edges(const HistoryRecord& record) const
+{
+    QHash<QString, qint64> result;
+    if (record.edgesOffset < 0) {
+        return result;
+    }
+    QFile file(basePath(record.project) + EDGES_SUFFIX);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(record.edgesOffset)) {
+        return result;
+    }
+    QByteArray text = qUncompress(file.read(record.edgesSize));
+    for (const QByteArray& line : text.split('\n')) {
+        int tab = line.lastIndexOf('\t');
+        if (tab > 0) {
+            result.insert(QString::fromUtf8(line.left(tab)), line.mid(tab + 1).toLongLong());
+        }
+    }
+    return result;
+}
+
+bool BuildHistory::isRegression(qint64 wallMs, qint64 baseline)
+{
+    return baseline > 0 && wallMs > baseline * REGRESSION_RATIO;
+}
+
+qint64 BuildHistory::baseline(const QVector<HistoryRecord>& records, int index, int window)
+{
+    const HistoryRecord& current = records.at(index);
+    QVector<qint64> samples;
+    for (int i = index - 1; i >= 0 && samples.size() < window; --i) {
+        const HistoryRecord& r = records.at(i);
+        if (!r.success || r.key() != current.key()) {
+            continue;
+        }
+        // 增量构建的耗时取决于执行了多少步骤，只和规模相近的构建比较
+        if (current.kind == "build" && qAbs(r.edges - current.edges) > current.edges / 10) {
+            continue;
+        }
+        samples << r.wallMs;
+    }
+    if (samples.size() < 3) {
+        return -1;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples.at(samples.size() / 2);
+}
+
+QString BuildHistory::gitHead(const QString& sourceDir)
+{
+    if (sourceDir.isEmpty()) {
+        return QString();
+    }
+    // 向上查找 .git；工作树中的 .git 可能是指向实际目录的 "gitdir: " 文件
+    QDir dir(sourceDir);
+    QString gitDir;
+    do {
+        QFileInfo info(dir.filePath(".git"));
+        if (info.isDir()) {
+            gitDir = info.filePath();
+        } else if (info.isFile()) {
+            QFile file(info.filePath());
+            if (file.open(QIODevice::ReadOnly)) {
+                QString line = QString::fromUtf8(file.readLine()).trimmed();
+                if (line.startsWith("gitdir: ")) {
+                    gitDir = QDir(dir.path()).absoluteFilePath(line.mid(8));
+                }
+            }
+        }
+    } while (gitDir.isEmpty() && dir.cdUp());
+    if (gitDir.isEmpty()) {
+        return QString();
+    }
+
+    QFile head(gitDir + "/HEAD");
+    if (!head.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    QString ref = QString::fromUtf8(head.readLine()).trimmed();
+    if (!ref.startsWith("ref: ")) {
+        return ref.left(12);
+    }
+    ref = ref.mid(5);
+
+    // 工作树的分支引用在公共目录中
+    QString commonDir = gitDir;
+    QFile common(gitDir + "/commondir");
+    if (common.open(QIODevice::ReadOnly)) {
+        commonDir = QDir(gitDir).absoluteFilePath(QString::fromUtf8(common.readLine()).trimmed());
+    }
+    QFile refFile(commonDir + "/" + ref);
+    if (refFile.open(QIODevice::ReadOnly)) {
+        return QString::fromUtf8(refFile.readLine()).trimmed().left(12);
+    }
+    QFile packed(commonDir + "/packed-refs");
+    if (packed.open(QIODevice::ReadOnly)) {
+        while (!packed.atEnd()) {
+            QString line = QString::fromUtf8(packed.readLine()).trimmed();
+            if (line.endsWith(" " + ref)) {
+                return line.left(12);
+            }
+        }
+    }
+    return QString();
+}
@@ -0,0 +1,66 @@
+#ifndef BUILDHISTORY_H
+#define BUILDHISTORY_H
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "ninjalog.h"
+
+// 一次配置或构建的记录
+struct HistoryRecord {
+    qint64 time{};   // 结束时间，毫秒时间戳
+    QString kind;    // configure 或 build
+    QString project;
+    QString mode;
+    QString target;
+    QString generator;
+    QString commit;   // 源码目录的 git HEAD
+    int exitCode{};
+    bool success{};
+    qint64 wallMs{};
+    qint64 cpuMs{};
+    int edges{};
+    double parallelism{};
+    qint64 criticalMs{};
+    QVector<QPair<QString, qint64>> slowest;
+    // 每条边的耗时在 .edges 文件中的位置，没有时 edgesOffset 为 -1
+    qint64 edgesOffset{-1};
+    int edgesSize{};
+
+    // 只有同一项目、模式、目标和类型的记录可以相互比较
+    QString key() const;
+};
+
+// 按项目保存的构建历史，只追加不修改：
+//   <项目>.jsonl   每行一条记录的概要
+//   <项目>.edges   每次构建各条边的耗时（"输出\t毫秒" 行，qCompress 压缩），由记录中的偏移引用
+class BuildHistory
+{
+public:
+    explicit BuildHistory(const QString& dir);
+
+public:
+    bool append(const HistoryRecord& record, const QVector<NinjaEdge>& edges, QString& error);
+    QVector<HistoryRecord> load(const QString& project) const;
+    QStringList projects() const;
+    // 输出 -> 耗时（毫秒）
+    QHash<QString, qint64> edges(const HistoryRecord& record) const;
+
+    // 滚动基线：此前最近 window 条可比较的成功记录的墙钟时间中位数，构建只和执行边数相近（±10%）的比较。
+    // 可比较的记录少于 3 条时返回 -1
+    static qint64 baseline(const QVector<HistoryRecord>& records, int index, int window = 10);
+    static bool isRegression(qint64 wallMs, qint64 baseline);
+    // 读取 .git/HEAD 指向的提交，不调用 git
+    static QString gitHead(const QString& sourceDir);
+
+private:
+    QString basePath(const QString& project) const;
+
+private:
+    QString dir_;
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include "buildtrace.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QSet>
+#include <QSysInfo>
+#include <QThread>
+#include <algorithm>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr int TOOL_PID = 1;
+constexpr int NINJA_PID = 2;
+constexpr int PHASE_TID = 0;
+constexpr int EVENT_TID = 1;
+
+json metadata(const char* name, int pid, int tid, const QString& value)
+{
+    json j;
+    j["name"] = name;
+    j["ph"] = "M";
+    j["pid"] = pid;
+    j["tid"] = tid;
+    j["args"]["name"] = value.toStdString();
+    return j;
+}
+
+const char* kindName(NinjaEdge::Kind kind)
+{
+    switch (kind) {
+    case NinjaEdge::Compile:
+        return "compile";
+    case NinjaEdge::Link:
+        return "link";
+    default:
+        return "other";
+    }
+}
+
+}   // namespace
+
+namespace BuildTrace {
+
+QVector<int> assignLanes(const QVector<NinjaEdge>& edges, int* laneCount)
+{
+    QVector<int> order(edges.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&edges](int a, int b) { return edges[a].start < edges[b].start; });
+
+    QVector<int> lanes(edges.size(), 0);
+    QVector<qint64> busyUntil;
+    for (int i : order) {
+        int lane = 0;
+        while (lane < busyUntil.size() && busyUntil[lane] > edges[i].start) {
+            ++lane;
+        }
+        if (lane == busyUntil.size()) {
+            busyUntil.append(0);
+        }
+        busyUntil[lane] = edges[i].end;
+        lanes[i] = lane;
+    }
+    if (laneCount) {
+        *laneCount = busyUntil.size();
+    }
+    return lanes;
+}
+
+bool write(const QString& file, const BuildReport& report, qint64 buildStartMs, const QVector<Marker>& markers,
+           const QMap<QString, QString>& info, QString& error)
+{
+    // 以最早的事件为 0 点，trace-event 的时间单位为微秒
+    qint64 origin = buildStartMs;
+    for (const Marker& m : markers) {
+        origin = qMin(origin, m.startMs);
+    }
+    auto us = [origin](qint64 ms) { return (ms - origin) * 1000; };
+
+    json events = json::array();
+    events.push_back(metadata("process_name", TOOL_PID, 0, "cmakeBuilder"));
+    events.push_back(metadata("thread_name", TOOL_PID, PHASE_TID, "阶段"));
+    events.push_back(metadata("thread_name", TOOL_PID, EVENT_TID, "事件"));
+    events.push_back(metadata("process_name", NINJA_PID, 0, "ninja"));
+
+    for (const Marker& m : markers) {
+        bool phase = m.category == "configure" || m.category == "build";
+        json j;
+        j["name"] = m.name.toStdString();
+        j["cat"] = m.category.toStdString();
+        j["pid"] = TOOL_PID;
+        j["tid"] = phase ? PHASE_TID : EVENT_TID;
+        j["ts"] = us(m.startMs);
+        if (m.endMs >= 0) {
+            j["ph"] = "X";
+            j["dur"] = (m.endMs - m.startMs) * 1000;
+        } else {
+            j["ph"] = "i";
+            j["s"] = "t";
+        }
+        if (!m.detail.isEmpty()) {
+            j["args"]["detail"] = m.detail.toStdString();
+        }
+        events.push_back(j);
+    }
+
+    int laneCount = 0;
+    QVector<int> lanes = assignLanes(report.edges, &laneCount);
+    for (int lane = 0; lane < laneCount; ++lane) {
+        events.push_back(metadata("thread_name", NINJA_PID, lane, QString("worker %1").arg(lane)));
+    }
+    QSet<int> critical;
+    for (int index : report.criticalPath) {
+        critical.insert(index);
+    }
+    for (int i = 0; i < report.edges.size(); ++i) {
+        const NinjaEdge& edge = report.edges.at(i);
+        json outputs = json::array();
+        for (const QString& out : edge.outputs) {
+            outputs.push_back(out.toStdString());
+        }
+        json j;
+        j["name"] = edge.outputs.first().toStdString();
+        j["cat"] = std::string(kindName(edge.kind)) + (critical.contains(i) ? ",critical" : "");
+        j["ph"] = "X";
+        j["pid"] = NINJA_PID;
+        j["tid"] = lanes.at(i);
+        j["ts"] = us(buildStartMs + edge.start);
+        j["dur"] = edge.duration() * 1000;
+        j["args"]["outputs"] = outputs;
+        j["args"]["rule"] = edge.rule.toStdString();
+        j["args"]["critical"] = critical.contains(i);
+        events.push_back(j);
+    }
+
+    json other;
+    other["host"] = QSysInfo::machineHostName().toStdString();
+    other["os"] = QSysInfo::prettyProductName().toStdString();
+    other["cpu"] = QSysInfo::currentCpuArchitecture().toStdString();
+    other["threads"] = QThread::idealThreadCount();
+    other["exported"] = QDateTime::currentDateTime().toString(Qt::ISODate).toStdString();
+    other["wallMs"] = report.wallMs;
+    other["cpuMs"] = report.cpuMs;
+    other["parallelism"] = report.parallelism;
+    other["criticalMs"] = report.criticalMs;
+    other["workers"] = laneCount;
+    for (auto it = info.constBegin(); it != info.constEnd(); ++it) {
+        other[it.key().toStdString()] = it.value().toStdString();
+    }
+
+    json trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = "ms";
+    trace["otherData"] = other;
+
+    // 用 QFile 写入，Windows 上的中文路径才能正确打开
+    QFile out(file);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = out.errorString();
+        return false;
+    }
+    try {
+        QByteArray data = QByteArray::fromStdString(trace.dump());
+        if (out.write(data) != data.size()) {
+            error = out.errorString();
+            return false;
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+}   // namespace BuildTrace
@@ -0,0 +1,32 @@
+#ifndef BUILDTRACE_H
+#define BUILDTRACE_H
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "ninjalog.h"
+
+// 把一次构建导出为 Chrome trace-event JSON，可直接在 Perfetto 或 chrome://tracing 中打开。
+// ninja 的每条边按执行时间重建到工作线程上；配置阶段和本工具自身的事件作为标记放在单独的进程下。
+namespace BuildTrace {
+
+struct Marker {
+    QString name;
+    QString category;   // configure、build 为阶段，其余为事件
+    qint64 startMs{};   // 毫秒时间戳
+    qint64 endMs{-1};   // 小于 0 为瞬时事件
+    QString detail;
+};
+
+// 按开始时间把边分配到最小编号的空闲工作线程，返回每条边的线程号
+QVector<int> assignLanes(const QVector<NinjaEdge>& edges, int* laneCount = nullptr);
+
+// buildStartMs 为构建进程启动的时间戳，ninja 日志中的时间以它为 0 点；
+// info 写入 otherData，便于比较不同机器上的构建
+bool write(const QString& file, const BuildReport& report, qint64 buildStartMs, const QVector<Marker>& markers,
+           const QMap<QString, QString>& info, QString& error);
+
+}   // namespace BuildTrace
+
+#endif
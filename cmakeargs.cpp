@@ -0,0 +1,374 @@
+#include "cmakeargs.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QRegularExpression>
+#include <QTextStream>
+
+#include "ninjastatus.h"
+
+namespace {
+
+constexpr auto TIME_TRACE_FLAG = "-ftime-trace";
+// 记录多配置生成器下追加到 <变量>_<CONFIG> 的内容，下次配置时先去掉再追加
+constexpr auto APPEND_PREFIX = "CMAKEBUILDER_APPEND_";
+
+// 读取构建树 CMakeCache.txt 中的变量值，不存在时为空；found 区分变量不存在和值为空
+QString cacheValue(const QString& buildTree, const QString& name, bool* found = nullptr)
+{
+    if (found) {
+        *found = false;
+    }
+    QFile file(buildTree + "/CMakeCache.txt");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    QByteArray prefix = name.toUtf8() + ":";
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        if (!line.startsWith(prefix)) {
+            continue;
+        }
+        int eq = line.indexOf('=');
+        if (found) {
+            *found = true;
+        }
+        return eq < 0 ? QString() : QString::fromUtf8(line.mid(eq + 1)).trimmed();
+    }
+    return QString();
+}
+
+// 缓存中以 prefix 开头的全部变量，键为去掉前缀后的名字
+QMap<QString, QString> cacheEntries(const QString& buildTree, const QString& prefix)
+{
+    QMap<QString, QString> entries;
+    QFile file(buildTree + "/CMakeCache.txt");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return entries;
+    }
+    QByteArray bytes = prefix.toUtf8();
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        int colon = line.indexOf(':');
+        int eq = line.indexOf('=');
+        if (!line.startsWith(bytes) || colon < 0 || eq < colon) {
+            continue;
+        }
+        entries.insert(QString::fromUtf8(line.mid(bytes.size(), colon - bytes.size())),
+                       QString::fromUtf8(line.mid(eq + 1)).trimmed());
+    }
+    return entries;
+}
+
+QStringList splitFlags(const QString& flags)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    return flags.split(' ', Qt::SkipEmptyParts);
+#else
+    return flags.split(' ', QString::SkipEmptyParts);
+#endif
+}
+
+// 从 flags 中去掉 removed 的每一项各一次，从后往前找：追加的内容总在默认值之后（_INIT 合并时在之前，只出现一次）
+QStringList removeFlags(QStringList flags, const QString& removed)
+{
+    for (const QString& flag : splitFlags(removed)) {
+        int pos = flags.lastIndexOf(flag);
+        if (pos >= 0) {
+            flags.removeAt(pos);
+        }
+    }
+    return flags;
+}
+
+int argIndex(const QStringList& args, const QString& name)
+{
+    for (int i = 0; i < args.size(); ++i) {
+        if (args.at(i).startsWith("-D" + name + ":") || args.at(i).startsWith("-D" + name + "=")) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 多配置生成器所有构建类型共用一份缓存，按模式筛选会使切换模式时参数变化而重新配置、互相覆盖；
+// 限定模式的编译和链接选项改为对应配置的 <变量>_<CONFIG>，其他变量没有按配置区分的形式，不予应用
+bool perConfigRow(const AddArgItem& item)
+{
+    return item.name.trimmed().endsWith("_FLAGS");
+}
+
+// -ftime-trace 只有 Clang 支持（含 AppleClang 和 clang-cl）。优先使用缓存中 CMake 识别出的编译器；
+// 新构建树还没有识别结果，按 CC/CXX 环境变量指定的编译器判断
+bool isClang(const QString& buildTree, const QString& lang, const QProcessEnvironment& env)
+{
+    bool found = false;
+    QString id = cacheValue(buildTree, "CMAKE_" + lang + "_COMPILER_ID", &found);
+    if (found) {
+        return id.contains("Clang");
+    }
+    QString compiler = env.value(lang == "C" ? "CC" : "CXX");
+    return QFileInfo(compiler).fileName().contains("clang", Qt::CaseInsensitive);
+}
+
+}   // namespace
+
+namespace CMakeArgs {
+
+bool isMultiConfig(const QString& generator)
+{
+    return generator.endsWith("Multi-Config");
+}
+
+QStringList configurationTypes()
+{
+    return {"Debug", "Release", "RelWithDebInfo"};
+}
+
+QString buildTree(const QString& buildDir, const QString& generator, const QString& mode)
+{
+    if (buildDir.isEmpty() || mode.isEmpty() || isMultiConfig(generator)) {
+        return buildDir;
+    }
+    return QDir::cleanPath(buildDir + "/" + mode);
+}
+
+QString ninjaFile(const QString& buildDir, const QString& generator, const QString& mode)
+{
+    QString tree = buildTree(buildDir, generator, mode);
+    if (isMultiConfig(generator)) {
+        return tree + "/build-" + mode + ".ninja";
+    }
+    return tree + "/build.ninja";
+}
+
+QStringList readTargets(const QString& ninjaFile)
+{
+    QStringList targetFiles;
+    QFile file(ninjaFile);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return targetFiles;
+    }
+
+    QTextStream stream(&file);
+    QString content = stream.readAll();
+    file.close();
+
+    // 使用正则表达式匹配所有 TARGET_FILE = 行
+    QRegularExpression regex(R"(TARGET_FILE\s*=\s*([^\s]+))");
+    QRegularExpressionMatchIterator matches = regex.globalMatch(content);
+
+    while (matches.hasNext()) {
+        QRegularExpressionMatch match = matches.next();
+        QString targetFile = match.captured(1).trimmed();
+        targetFiles.append(targetFile);
+    }
+    targetFiles.removeDuplicates();
+    return targetFiles;
+}
+
+QString expandEnvVar(const QProcessEnvironment& env, const QString& str)
+{
+    QString result = str;
+
+    // 展开 %VAR% 格式的环境变量（Windows）
+    QRegularExpression winRe("%([^%]+)%");
+    QRegularExpressionMatchIterator winIt = winRe.globalMatch(str);
+    while (winIt.hasNext()) {
+        QRegularExpressionMatch match = winIt.next();
+        QString varName = match.captured(1);
+        if (env.contains(varName)) {
+            result.replace("%" + varName + "%", env.value(varName));
+        }
+    }
+
+    // 展开 $VAR 或 ${VAR} 格式的环境变量（Unix）
+    QRegularExpression unixRe("\\$(?:{([^}]+)}|(\\w+))");
+    QRegularExpressionMatchIterator unixIt = unixRe.globalMatch(str);
+    while (unixIt.hasNext()) {
+        QRegularExpressionMatch match = unixIt.next();
+        QString varName = match.captured(1).isEmpty() ? match.captured(2) : match.captured(1);
+        if (env.contains(varName)) {
+            if (match.captured(0).startsWith("${")) {
+                result.replace("${" + varName + "}", env.value(varName));
+            } else {
+                result.replace("$" + varName, env.value(varName));
+            }
+        }
+    }
+
+    return result;
+}
+
+QStringList additional(const OneConfig& o, const QString& mode, const QProcessEnvironment& env)
+{
+    QStringList args;
+    bool multiConfig = isMultiConfig(o.curType.isEmpty() ? QString("Ninja") : o.curType);
+    QMap<QString, QString> appends;
+    for (const AddArgItem& item : o.additonArgs) {
+        // 跳过空行
+        if (item.name.isEmpty()) {
+            continue;
+        }
+        QString name = item.name.trimmed();
+        if (item.mode != "All") {
+            if (!multiConfig) {
+                if (item.mode != mode) {
+                    continue;
+                }
+            } else {
+                if (perConfigRow(item)) {
+                    QString value = expandEnvVar(env, item.value.trimmed());
+                    QString& appended = appends[name + "_" + item.mode.toUpper()];
+                    appended = splitFlags(appended + " " + value).join(' ');
+                }
+                continue;
+            }
+        }
+        QString value = expandEnvVar(env, item.value.trimmed());
+        if (!value.isEmpty()) {
+            args << "-D" + name + ":" + item.type + "=" + value;
+        }
+    }
+    QString tree = buildTree(o.buildDir, o.curType, mode);
+
+    // 按配置的选项追加到该配置现有的值之后，保留 CMake 的默认值（如 Release 的 -O3 -DNDEBUG）。
+    // 上次追加的内容记在缓存中，先从缓存值中去掉再追加，参数保持不变，修改或删除表中的行也能还原；
+    // 新构建树还没有默认值，通过 CMAKE_* 变量的 <变量>_INIT 让 CMake 初始化时合并
+    if (multiConfig) {
+        QMap<QString, QString> previous = cacheEntries(tree, APPEND_PREFIX);
+        for (auto it = previous.cbegin(); it != previous.cend(); ++it) {
+            if (!it.value().isEmpty() && !appends.contains(it.key())) {
+                appends.insert(it.key(), QString());
+            }
+        }
+        for (auto it = appends.cbegin(); it != appends.cend(); ++it) {
+            const QString& name = it.key();
+            int index = argIndex(args, name);
+            if (index >= 0) {
+                // 表中同时直接设置了该变量，以其值为基础
+                QString base = args.at(index).mid(args.at(index).indexOf('=') + 1);
+                args[index] = "-D" + name + ":STRING=" + splitFlags(base + " " + it.value()).join(' ');
+            } else {
+                bool cached = false;
+                QString base = cacheValue(tree, name, &cached);
+                if (cached || !name.startsWith("CMAKE_")) {
+                    QStringList flags = removeFlags(splitFlags(base), previous.value(name)) + splitFlags(it.value());
+                    args << "-D" + name + ":STRING=" + flags.join(' ');
+                } else if (!it.value().isEmpty()) {
+                    args << "-D" + name + "_INIT:STRING=" + it.value();
+                }
+            }
+            args << "-D" + QString(APPEND_PREFIX) + name + ":INTERNAL=" + it.value();
+        }
+    }
+
+    // 表中有同名变量时在其值后追加，否则以缓存中的值为基础；新构建树的缓存还没有该变量，
+    // 以 CMake 初始化时会读取的环境变量 CFLAGS/CXXFLAGS 为基础，避免 -D 覆盖掉它们。
+    // 关闭或编译器不是 Clang 时从缓存值中去掉上次注入的选项
+    static const char* langs[] = {"C", "CXX"};
+    for (const char* lang : langs) {
+        QString name = QString("CMAKE_%1_FLAGS").arg(lang);
+        int index = argIndex(args, name);
+        QString base;
+        if (index >= 0) {
+            base = args.at(index).mid(args.at(index).indexOf('=') + 1);
+        } else {
+            bool cached = false;
+            base = cacheValue(tree, name, &cached);
+            if (!cached) {
+                base = env.value(QString("%1FLAGS").arg(lang));
+            }
+        }
+        QStringList flags = splitFlags(base);
+        bool had = flags.removeAll(TIME_TRACE_FLAG) > 0;
+        if (o.timeTrace && isClang(tree, lang, env)) {
+            flags << TIME_TRACE_FLAG;
+        } else if (index >= 0 || !had) {
+            continue;
+        }
+        QString arg = "-D" + name + ":STRING=" + flags.join(' ');
+        if (index >= 0) {
+            args[index] = arg;
+        } else {
+            args << arg;
+        }
+    }
+    return args;
+}
+
+QStringList configureWarnings(const OneConfig& o, const QString& mode, const QProcessEnvironment& env)
+{
+    QStringList warnings;
+    if (isMultiConfig(o.curType.isEmpty() ? QString("Ninja") : o.curType)) {
+        for (const AddArgItem& item : o.additonArgs) {
+            if (!item.name.isEmpty() && item.mode != "All" && !perConfigRow(item)) {
+                warnings << QString("警告：多配置生成器所有构建类型共用一份缓存，仅限 %1 模式的参数 %2 无法按配置设置，未应用")
+                                .arg(item.mode, item.name.trimmed());
+            }
+        }
+    }
+
+    if (o.timeTrace) {
+        QString tree = buildTree(o.buildDir, o.curType, mode);
+        if (!isClang(tree, "CXX", env)) {
+            bool cached = false;
+            QString id = cacheValue(tree, "CMAKE_CXX_COMPILER_ID", &cached);
+            if (!cached) {
+                warnings << "提示：构建树尚未识别编译器，本次配置不注入 -ftime-trace；若编译器是 Clang，再次配置时生效";
+            } else {
+                warnings << QString("警告：编译耗时分析（-ftime-trace）仅支持 Clang，当前 C++ 编译器为 %1，未注入该选项")
+                                .arg(id.isEmpty() ? QString("未知") : id);
+            }
+        }
+    }
+    return warnings;
+}
+
+QStringList configure(const OneConfig& o, const QString& mode, const QProcessEnvironment& env)
+{
+    QStringList arguments;
+    arguments << "-S" << o.sourceDir;
+    QString generator = o.curType.isEmpty() ? QString("Ninja") : o.curType;
+    arguments << "-B" << buildTree(o.buildDir, generator, mode);
+    arguments << "-G" << generator;
+    if (isMultiConfig(generator)) {
+        // 构建类型在构建时由 --config 选择
+        arguments << "-DCMAKE_CONFIGURATION_TYPES:STRING=" + configurationTypes().join(";");
+    } else {
+        arguments << "-DCMAKE_BUILD_TYPE=" + mode;
+    }
+    arguments << "-DCMAKE_EXPORT_COMPILE_COMMANDS:BOOL=TRUE";
+    // 输出经过 ANSI 解码后按原样着色显示，让编译器在管道下也输出颜色（CMake 3.24+）
+    arguments << "-DCMAKE_COLOR_DIAGNOSTICS:BOOL=ON";
+    arguments << "-Wno-dev";
+    arguments << "--no-warn-unused-cli";
+    arguments << additional(o, mode, env);
+    return arguments;
+}
+
+QStringList build(const OneConfig& o, const QString& mode, const QString& target, int jobs)
+{
+    QStringList arguments;
+    arguments << "--build" << buildTree(o.buildDir, o.curType, mode);
+    arguments << "--config" << mode;
+    arguments << "--target" << QFileInfo(target).baseName();
+    arguments << "--parallel";
+    if (jobs > 0) {
+        arguments << QString::number(jobs);
+    }
+    return arguments;
+}
+
+QProcessEnvironment buildEnvironment(const QProcessEnvironment& env)
+{
+    QProcessEnvironment result = env;
+    result.insert("NINJA_STATUS", NINJA_STATUS_FORMAT);
+    result.insert("CLICOLOR_FORCE", "1");
+    return result;
+}
+
+}   // namespace CMakeArgs
@@ -0,0 +1,38 @@
+#ifndef CMAKEARGS_H
+#define CMAKEARGS_H
+
+#include <QProcessEnvironment>
+#include <QStringList>
+
+#include "config.h"
+
+// 由保存的项目配置生成 cmake 命令行，界面和任务队列共用同一套规则
+namespace CMakeArgs {
+
+// 多配置生成器一次配置即可构建所有构建类型
+bool isMultiConfig(const QString& generator);
+// 界面可选的构建类型，也是多配置生成器生成的全部配置
+QStringList configurationTypes();
+// 单配置生成器每种构建类型使用 buildDir 下的独立构建树，切换模式无需清空重建；
+// 多配置生成器所有构建类型共用 buildDir
+QString buildTree(const QString& buildDir, const QString& generator, const QString& mode);
+// 列出目标所用的 ninja 文件，多配置生成器为 build-<Config>.ninja
+QString ninjaFile(const QString& buildDir, const QString& generator, const QString& mode);
+// 从 ninja 文件的 TARGET_FILE 行读取全部目标（去重）
+QStringList readTargets(const QString& ninjaFile);
+// 展开 %VAR%、$VAR 和 ${VAR} 形式的环境变量
+QString expandEnvVar(const QProcessEnvironment& env, const QString& str);
+// 附加参数表中适用于 mode 的 -D 参数；开启 timeTrace 时把 -ftime-trace 合并进 C/C++ 编译选项。
+// 多配置生成器的结果与 mode 无关：限定模式的 *_FLAGS 行追加到 *_FLAGS_<CONFIG> 的现有值之后，其余限定模式的行忽略
+QStringList additional(const OneConfig& o, const QString& mode, const QProcessEnvironment& env);
+// 配置前需要告知用户的问题：被忽略的附加参数行，以及开启 timeTrace 但 C++ 编译器不是 Clang（或尚未识别）
+QStringList configureWarnings(const OneConfig& o, const QString& mode, const QProcessEnvironment& env);
+QStringList configure(const OneConfig& o, const QString& mode, const QProcessEnvironment& env);
+// jobs 为 0 时交给构建工具自行决定并行数
+QStringList build(const OneConfig& o, const QString& mode, const QString& target, int jobs = 0);
+// 构建时的环境：ninja 状态行改为可解析的格式，并强制彩色输出
+QProcessEnvironment buildEnvironment(const QProcessEnvironment& env);
+
+}   // namespace CMakeArgs
+
+#endif
@@ -1,64 +1,34 @@
 #include "cmakebuilder.h"
 
+#include <QApplication>
+#include <QCheckBox>
+#include <QDateTime>
 #include <QDesktopServices>
+#include <QDialogButtonBox>
 #include <QDir>
 #include <QFileDialog>
 #include <QInputDialog>
+#include <QListWidget>
 #include <QMenu>
 #include <QMessageBox>
-#include <QScrollBar>
+#include <QShortcut>
+#include <QTabBar>
+#include <QThread>
 #include <QTimer>
+#include <algorithm>
 
 #include "./ui_cmakebuilder.h"
-
-#if defined(_WIN32)
-#include <windows.h>
-std::string u8_to_ansi(const std::string& str)
-{
-    int wideCharLen = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, nullptr, 0);
-    if (wideCharLen <= 0) {
-        return "";
-    }
-    std::wstring wideStr(wideCharLen, L'\0');
-    MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, &wideStr[0], wideCharLen);
-    int gbkLen = WideCharToMultiByte(CP_ACP, 0, wideStr.c_str(), -1, nullptr, 0, nullptr, nullptr);
-    if (gbkLen <= 0) {
-        return "";
-    }
-    std::string gbkStr(gbkLen, '\0');
-    WideCharToMultiByte(CP_ACP, 0, wideStr.c_str(), -1, &gbkStr[0], gbkLen, nullptr, nullptr);
-
-    gbkStr.resize(gbkLen - 1);
-    return gbkStr;
-}
-std::string ansi_to_u8(const std::string& str)
-{
-    int wideCharLen = MultiByteToWideChar(CP_ACP, 0, str.c_str(), -1, nullptr, 0);
-    if (wideCharLen <= 0) {
-        return "";
-    }
-    std::wstring wideStr(wideCharLen, L'\0');
-    MultiByteToWideChar(CP_ACP, 0, str.c_str(), -1, &wideStr[0], wideCharLen);
-
-    int utf8Len = WideCharToMultiByte(CP_UTF8, 0, wideStr.c_str(), -1, nullptr, 0, nullptr, nullptr);
-    if (utf8Len <= 0) {
-        return "";
-    }
-    std::string utf8Str(utf8Len, '\0');
-    WideCharToMultiByte(CP_UTF8, 0, wideStr.c_str(), -1, &utf8Str[0], utf8Len, nullptr, nullptr);
-
-    utf8Str.resize(utf8Len - 1);
-    return utf8Str;
-}
-QString code_handle(const QString& str)
-{
-    auto s = str.toStdString();
-    s = u8_to_ansi(s);
-    return QString::fromStdString(s);
-}
-#endif
+#include "cmakeargs.h"
+#include "historydialog.h"
+#include "jobqueue.h"
+#include "logsink.h"
+#include "ninjalog.h"
+#include "processrunner.h"
+#include "vcenv.h"
 
 constexpr auto SL = "----------------------------------------------";
+// 未配置时日志的默认内存上限（MB）
+constexpr int DEFAULT_LOG_LIMIT_MB = 64;
 
 CmakeBuilder::CmakeBuilder(QWidget* parent) : QDialog(parent), ui(new Ui::CmakeBuilder)
 {
@@ -67,8 +37,8 @@ CmakeBuilder::CmakeBuilder(QWidget* parent) : QDialog(parent), ui(new Ui::CmakeB
     config_ = new BuilderConfig(this);
 
     InitData();
-    LoadConfig();
     BaseInit();
+    LoadConfig();
 
     setWindowTitle("cmakeBuilder v1.1.1");
     setWindowFlags(windowFlags() | Qt::WindowMinMaxButtonsHint);
@@ -81,6 +51,7 @@ CmakeBuilder::CmakeBuilder(QWidget* parent) : QDialog(parent), ui(new Ui::CmakeB
 
 CmakeBuilder::~CmakeBuilder()
 {
+    delete history_;
     delete ui;
 }
 
@@ -101,13 +72,21 @@ void CmakeBuilder::closeEvent(QCloseEvent* event)
 
 void CmakeBuilder::InitData()
 {
-    process_ = new QProcess(this);
+    process_ = new ProcessRunner(this);
+    jobs_ = new JobQueue(this);
+    logSink_ = new LogSink(ui->pedOutput, this);
 
-    modes_ = {"All", "Debug", "Release"};
+    modes_ = {"All"};
+    for (const QString& mode : CMakeArgs::configurationTypes()) {
+        modes_.append(mode);
+    }
 
     InitTab();
+    InitDiagPanel();
+    InitReportPanel();
+    InitSearch();
 
-    auto configDir = QDir::homePath() + "/.config/cmakeBuilder";
+    auto configDir = BuilderConfig::defaultDir();
     QDir dir(configDir);
     if (!dir.exists()) {
         if (!dir.mkpath(".")) {
@@ -119,21 +98,25 @@ void CmakeBuilder::InitData()
     config_->setConfigDir(configDir + "/config.json");
     config_->setConfigSizeDir(configDir + "/size.json");
     config_->setConfigUseDir(configDir + "/curuse.json");
+    history_ = new BuildHistory(configDir + "/history");
 
     ui->cbProject->setEditable(true);
     ui->cbProject->setMinimumWidth(150);
     ui->edCMake->setFocusPolicy(Qt::ClickFocus);
-    ui->pedOutput->setReadOnly(true);
+    InitLogLimit(configDir);
+    InitQueue();
+    InitPty();
 
     // ui->btnConfig->setStyleSheet("background-color: red;");
     // ui->btnBuild->setStyleSheet("background-color: blue;");
 
     connect(ui->btnStart, &QPushButton::clicked, this, &CmakeBuilder::StartExe);
     connect(this, &CmakeBuilder::sigPrint, this, [this](const QString& msg) { Print(msg); });
-    connect(process_, &QProcess::readyReadStandardOutput, this, &CmakeBuilder::onProcessReadyRead);
-    connect(process_, &QProcess::readyReadStandardError, this, &CmakeBuilder::onProcessReadyRead);
-    connect(process_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &CmakeBuilder::onProcessFinished);
-    connect(process_, &QProcess::errorOccurred, this, &CmakeBuilder::onProcessError);
+    connect(process_, &ProcessRunner::sigOutput, this, &CmakeBuilder::onProcessReadyRead);
+    connect(process_, &ProcessRunner::sigProgress, this, &CmakeBuilder::onBuildProgress);
+    connect(process_, &ProcessRunner::sigFinished, this, &CmakeBuilder::onProcessFinished);
+    connect(process_, &ProcessRunner::sigStarted, this, &CmakeBuilder::onProcessStarted);
+    connect(process_, &ProcessRunner::sigError, this, &CmakeBuilder::onProcessError);
     connect(ui->btnSaveConfig, &QPushButton::clicked, this, &CmakeBuilder::SaveCur);
     connect(ui->btnLoadConfig, &QPushButton::clicked, this, &CmakeBuilder::SimpleLoad);
     connect(ui->btnDelConfig, &QPushButton::clicked, this, [this]() {
@@ -155,6 +138,11 @@ void CmakeBuilder::InitData()
         }
     });
     connect(ui->btnClearEnv, &QPushButton::clicked, this, [this]() { ui->edVcEnv->clear(); });
+    connect(ui->btnHistory, &QPushButton::clicked, this, [this]() {
+        HistoryDialog* dlg = new HistoryDialog(history_, ui->cbProject->currentText().trimmed(), this);
+        dlg->setAttribute(Qt::WA_DeleteOnClose);
+        dlg->show();
+    });
     connect(this, &CmakeBuilder::sigEnableBtn, this, [this](bool enable) {
         if (enable) {
             EnableBtn();
@@ -169,11 +157,16 @@ void CmakeBuilder::InitData()
             return;
         }
         Print("开始清空...");
-        auto buildDir = ui->edBuildDir->text().trimmed();
+        // 只清空当前构建类型的构建树，其他模式的构建结果保留
+        auto buildDir = CurrentBuildTree();
+        if (jobs_->isDirBusy(buildDir)) {
+            Print("队列中的任务正在使用该构建目录，请等待完成...", true);
+            return;
+        }
         QDir dir(buildDir);
         if (dir.exists()) {
             if (dir.removeRecursively()) {
-                Print("已清空旧模式的构建目录: " + buildDir);
+                Print("已清空构建目录: " + buildDir);
                 QDir().mkpath(buildDir);
                 ui->cbTarget->clear();
             } else {
@@ -185,6 +178,53 @@ void CmakeBuilder::InitData()
     connect(ui->btnCancel, &QPushButton::clicked, this, &CmakeBuilder::terminalProcess);
 }
 
+void CmakeBuilder::InitLogLimit(const QString& configDir)
+{
+    auto logDir = configDir + "/logs";
+    QDir().mkpath(logDir);
+    logDir_ = logDir;
+
+    int limit = config_->getLogLimit();
+    if (limit <= 0) {
+        limit = DEFAULT_LOG_LIMIT_MB;
+    }
+    LogStore* store = ui->pedOutput->store();
+    store->setSpillDir(logDir);
+    store->setMemoryLimit(static_cast<qint64>(limit) * 1024 * 1024);
+
+    QAction* limitAction = new QAction("日志内存上限...", this);
+    connect(limitAction, &QAction::triggered, this, [this]() {
+        int cur = config_->getLogLimit();
+        bool ok = false;
+        int mb = QInputDialog::getInt(this, "日志内存上限", "超出后旧日志压缩或转存到磁盘 (MB)：",
+                                      cur > 0 ? cur : DEFAULT_LOG_LIMIT_MB, 8, 1024 * 64, 8, &ok);
+        if (!ok) {
+            return;
+        }
+        if (config_->setLogLimit(mb)) {
+            ui->pedOutput->store()->setMemoryLimit(static_cast<qint64>(mb) * 1024 * 1024);
+        }
+    });
+    ui->pedOutput->addContextAction(limitAction);
+}
+
+void CmakeBuilder::InitPty()
+{
+#ifdef Q_OS_LINUX
+    QAction* ptyAction = new QAction("在伪终端中运行", this);
+    ptyAction->setCheckable(true);
+    ptyAction->setChecked(config_->getUsePty());
+    process_->setUsePty(ptyAction->isChecked());
+    jobs_->setUsePty(ptyAction->isChecked());
+    connect(ptyAction, &QAction::toggled, this, [this](bool checked) {
+        config_->setUsePty(checked);
+        process_->setUsePty(checked);
+        jobs_->setUsePty(checked);
+    });
+    ui->pedOutput->addContextAction(ptyAction);
+#endif
+}
+
 void CmakeBuilder::LoadConfig()
 {
     QVector<QString> keys;
@@ -203,6 +243,7 @@ void CmakeBuilder::LoadConfig()
         return;
     }
     SetUi(o);
+    LoadTargets();
     ui->cbProject->clear();
     for (auto& item : keys) {
         ui->cbProject->addItem(item);
@@ -218,6 +259,7 @@ bool CmakeBuilder::SimpleLoad()
         return false;
     }
     SetUi(o);
+    LoadTargets();
     return true;
 }
 
@@ -229,6 +271,7 @@ OneConfig CmakeBuilder::ReadUi()
     o.buildDir = ui->edBuildDir->text().trimmed().replace('\\', '/');
     o.vcEnv = ui->edVcEnv->text().trimmed().replace('\\', '/');
     o.arg = ui->edArg->text().trimmed();
+    o.timeTrace = ui->ckTimeTrace->isChecked();
     o.additonArgs.clear();
 
     for (int i = 0; i < ui->tableWidget->rowCount(); ++i) {
@@ -242,6 +285,16 @@ OneConfig CmakeBuilder::ReadUi()
     return o;
 }
 
+OneConfig CmakeBuilder::CurrentJobConfig()
+{
+    OneConfig o = ReadUi();
+    o.key = ui->cbProject->currentText().trimmed();
+    o.curType = ui->cbType->currentText();
+    o.curMode = ui->cbMode->currentText();
+    o.curTarget = ui->cbTarget->currentText();
+    return o;
+}
+
 void CmakeBuilder::SetUi(const OneConfig& o)
 {
     // 设置基本路径
@@ -250,6 +303,13 @@ void CmakeBuilder::SetUi(const OneConfig& o)
     ui->edBuildDir->setText(o.buildDir);
     ui->edVcEnv->setText(o.vcEnv);
     ui->edArg->setText(o.arg);
+    ui->ckTimeTrace->setChecked(o.timeTrace);
+    if (ui->cbType->findText(o.curType) >= 0) {
+        ui->cbType->setCurrentText(o.curType);
+    }
+    if (ui->cbMode->findText(o.curMode) >= 0) {
+        ui->cbMode->setCurrentText(o.curMode);
+    }
     clearTable();
 
     for (int i = 0; i < o.additonArgs.count(); ++i) {
@@ -272,7 +332,8 @@ void CmakeBuilder::SaveCur(bool isNotice)
         QMessageBox::information(this, "提示", "输入配置名称");
         return;
     }
-    auto o = ReadUi();
+    // 生成器、构建类型和目标一并保存，队列中的任务按保存的设置执行
+    auto o = CurrentJobConfig();
     o.key = key;
     if (!config_->SaveData(o)) {
         QMessageBox::information(this, "提示", "保存失败");
@@ -284,9 +345,74 @@ void CmakeBuilder::SaveCur(bool isNotice)
 
 void CmakeBuilder::terminalProcess()
 {
-    // process_->terminate();
-    Print("强制终止cmake执行...");
-    process_->kill();
+    if (!process_->isRunning()) {
+        return;
+    }
+    Print("正在终止cmake执行（再次点击立即升级终止信号）...");
+    process_->cancel();
+}
+
+QString CmakeBuilder::CurrentBuildTree()
+{
+    return CMakeArgs::buildTree(ui->edBuildDir->text().trimmed(), ui->cbType->currentText(), ui->cbMode->currentText());
+}
+
+void CmakeBuilder::LoadTargets()
+{
+    // 每种构建类型都有已生成的 ninja 文件（独立构建树或多配置的 build-<Config>.ninja），
+    // 切换模式时直接读取其中的目标，不需要重新配置
+    curTarget_ = ui->cbTarget->currentText();
+    buildFile_ = CMakeArgs::ninjaFile(ui->edBuildDir->text().trimmed(), ui->cbType->currentText(), ui->cbMode->currentText());
+    if (QFile::exists(buildFile_)) {
+        onBuildNinjaChanged(buildFile_);
+    } else {
+        ui->cbTarget->clear();
+        configRet_ = false;
+    }
+}
+
+bool CmakeBuilder::SkipConfigure(const QString& buildTree, const QString& cmake, const QStringList& arguments,
+                                 const QProcessEnvironment& env)
+{
+    qint64 checkStart = QDateTime::currentMSecsSinceEpoch();
+    pendingFingerprint_ = ConfigFingerprint::compute(cmake, arguments, env);
+    configTree_ = buildTree;
+
+    QString reason;
+    if (forceConfig_) {
+        reason = "强制重新配置";
+    } else if (ui->ckProfileConfig->isChecked()) {
+        reason = "分析配置耗时";
+    } else if (ConfigFingerprint::upToDate(buildTree, buildFile_, pendingFingerprint_, reason)) {
+        Mark("检查配置指纹", "lifecycle", checkStart, QDateTime::currentMSecsSinceEpoch(), reason);
+        Mark("跳过配置", "configure", QDateTime::currentMSecsSinceEpoch());
+        configMarkers_ = traceMarkers_.size();
+        Print("配置未变化，跳过 CMake 配置（" + reason + "）");
+        onBuildNinjaChanged(buildFile_);
+        return true;
+    }
+    Mark("检查配置指纹", "lifecycle", checkStart, QDateTime::currentMSecsSinceEpoch(), reason);
+    Print("执行 CMake 配置：" + reason);
+    ConfigFingerprint::invalidate(buildTree);
+    return false;
+}
+
+QStringList CmakeBuilder::ProfileArguments(const QString& buildTree)
+{
+    profileFile_.clear();
+    if (!ui->ckProfileConfig->isChecked()) {
+        return QStringList();
+    }
+    // 保留上一次的分析结果用于比较
+    QString file = ConfigProfile::outputFile(buildTree);
+    QString previous = ConfigProfile::previousFile(buildTree);
+    QDir(buildTree).mkpath("CMakeFiles");
+    if (QFile::exists(file)) {
+        QFile::remove(previous);
+        QFile::rename(file, previous);
+    }
+    profileFile_ = file;
+    return ConfigProfile::arguments(file);
 }
 
 void CmakeBuilder::InitTab()
@@ -334,7 +460,7 @@ void CmakeBuilder::InitTab()
 
 void CmakeBuilder::StartExe()
 {
-    QString basePath = ui->edBuildDir->text();
+    QString basePath = CurrentBuildTree();
     QString relativePath = ui->cbTarget->currentText();
 
     basePath = basePath.trimmed();
@@ -384,6 +510,7 @@ void CmakeBuilder::StartExe()
 void CmakeBuilder::BaseInit()
 {
     ui->cbType->addItem("Ninja");
+    ui->cbType->addItem("Ninja Multi-Config");
     ui->cbType->setCurrentText(0);
 
     for (int i = 0; i < modes_.size(); ++i) {
@@ -399,6 +526,7 @@ void CmakeBuilder::BaseInit()
     ui->cbType->setSizeAdjustPolicy(QComboBox::AdjustToContents);
 
     connect(ui->btnConfig, &QPushButton::clicked, this, &CmakeBuilder::cmakeConfigWithVCEnv);
+    ui->btnConfig->setToolTip("参数、环境和 CMake 输入文件未变化时跳过配置，按住 Shift 点击强制重新配置");
     connect(ui->btnBuild, &QPushButton::clicked, this, &CmakeBuilder::cmakeBuild);
     connect(ui->btnAddCmake, &QPushButton::clicked, this, [this]() {
         QString fileName = QFileDialog::getOpenFileName(this, "选择 CMake 可执行文件", QDir::homePath(),
@@ -448,36 +576,33 @@ void CmakeBuilder::BaseInit()
         }
     });
     // ui->btnCancel->setEnabled(false);
+
+    connect(ui->cbMode, &QComboBox::currentTextChanged, this, [this]() { LoadTargets(); });
+    connect(ui->cbType, &QComboBox::currentTextChanged, this, [this]() { LoadTargets(); });
+    connect(ui->edBuildDir, &QLineEdit::editingFinished, this, [this]() { LoadTargets(); });
+    LoadTargets();
 }
 
 void CmakeBuilder::cmakeConfig()
 {
-    ui->pedOutput->clear();
+    ClearOutput();
     configRet_ = false;
 
-    auto buildDir = ui->edBuildDir->text().trimmed();
+    auto buildDir = CurrentBuildTree();
     auto cmake = ui->edCMake->text().trimmed();
     auto target = ui->cbTarget->currentText();
     auto mode = ui->cbMode->currentText();
     curTarget_ = ui->cbTarget->currentText();
     ui->cbTarget->clear();
 
-    if (process_->state() == QProcess::Running) {
+    if (process_->isRunning()) {
         Print("CMake 进程正在运行，请等待完成...", true);
         return;
     }
 
-    if (!curType_.isEmpty() && ui->cbMode->currentText() != curType_) {
-        Print("模式已变更，重新执行配置。");
-        QDir dir(buildDir);
-        if (dir.exists()) {
-            if (dir.removeRecursively()) {
-                Print("已清空旧模式的构建目录: " + buildDir);
-                QDir().mkpath(buildDir);
-            } else {
-                Print("错误: 无法清空构建目录: " + buildDir);
-            }
-        }
+    if (jobs_->isDirBusy(buildDir)) {
+        Print("队列中的任务正在使用该构建目录，请等待完成...", true);
+        return;
     }
 
     QDir dir(buildDir);
@@ -488,25 +613,29 @@ void CmakeBuilder::cmakeConfig()
         }
     }
     process_->setWorkingDirectory(buildDir);
-    buildFile_ = buildDir + "/build.ninja";
+    buildFile_ = CMakeArgs::ninjaFile(ui->edBuildDir->text().trimmed(), ui->cbType->currentText(), ui->cbMode->currentText());
 
     // 3. 构建CMake参数
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
 
-    QStringList arguments;
-    arguments << "-S" << ui->edSource->text().trimmed();
-    arguments << "-B" << buildDir;
-    arguments << "-G" << ui->cbType->currentText();
-    arguments << "-DCMAKE_BUILD_TYPE=" + mode;
-    arguments << "-DCMAKE_EXPORT_COMPILE_COMMANDS:BOOL=TRUE";
-    arguments << "-Wno-dev";
-    arguments << "--no-warn-unused-cli";
-
-    QStringList additionalArgs = QStringList::fromVector(getAddArgsFromTable(env));
+    OneConfig o = CurrentJobConfig();
+    QStringList arguments = CMakeArgs::configure(o, mode, env);
+    QStringList additionalArgs = CMakeArgs::additional(o, mode, env);
     if (!additionalArgs.isEmpty()) {
-        arguments << additionalArgs;
         Print("生成的CMake参数: " + additionalArgs.join(" "));
     }
+    for (const QString& warning : CMakeArgs::configureWarnings(o, mode, env)) {
+        Print(warning);
+    }
+    traceMarkers_.clear();
+    configMarkers_ = 0;
+    // 跳过配置时后续构建沿用该环境，不能留着上一个项目（如另一套 VC 环境）的设置
+    process_->setProcessEnvironment(env);
+    if (SkipConfigure(buildDir, cmake, arguments, env)) {
+        return;
+    }
+    // 性能分析参数不计入配置指纹
+    arguments << ProfileArguments(buildDir);
 
     Print("开始执行 CMake 配置...");
     Print("命令: " + cmake + " " + arguments.join(" "));
@@ -515,14 +644,12 @@ void CmakeBuilder::cmakeConfig()
 
     DisableBtn();
 
-    process_->setProcessEnvironment(env);
+    PrepareHistory("configure", mode, QString());
+    taskStartMs_ = QDateTime::currentMSecsSinceEpoch();
+    jobs_->setExternalTask(buildDir, 1);
     process_->start(cmake, arguments);
 
     currentTaskName_ = "config";
-    if (!process_->waitForStarted(20000)) {
-        Print("错误：启动 CMake 进程超时", true);
-        return;
-    }
 }
 
 void CmakeBuilder::onBuildNinjaChanged(const QString& path)
@@ -543,15 +670,15 @@ void CmakeBuilder::onBuildNinjaChanged(const QString& path)
             }
         }
         curTarget_ = ui->cbTarget->currentText();
-        curType_ = ui->cbMode->currentText();
         configRet_ = true;
     } else {
-        Print("错误：未找到 build.ninja 文件", true);
+        Print("错误：未找到 " + QFileInfo(buildFile_).fileName() + " 文件", true);
     }
 }
 
 void CmakeBuilder::cmakeConfigWithVCEnv()
 {
+    forceConfig_ = QApplication::keyboardModifiers() & Qt::ShiftModifier;
     QString envBat = ui->edVcEnv->text().trimmed();
     if (envBat.isEmpty()) {
         cmakeConfig();
@@ -563,11 +690,11 @@ void CmakeBuilder::cmakeConfigWithVCEnv()
         return;
     }
 
-    ui->pedOutput->clear();
+    ClearOutput();
     configRet_ = false;
 
     // 获取配置参数
-    auto buildDir = ui->edBuildDir->text().trimmed();
+    auto buildDir = CurrentBuildTree();
     auto cmake = ui->edCMake->text().trimmed();
     auto sourceDir = ui->edSource->text().trimmed();
     auto generator = ui->cbType->currentText();
@@ -583,16 +710,24 @@ void CmakeBuilder::cmakeConfigWithVCEnv()
         return;
     }
 
-    if (process_->state() == QProcess::Running) {
+    if (process_->isRunning()) {
         QMessageBox::information(this, "提示", "CMake 进程正在运行，请等待完成...");
         return;
     }
 
+    if (jobs_->isDirBusy(buildDir)) {
+        QMessageBox::information(this, "提示", "队列中的任务正在使用该构建目录，请等待完成...");
+        return;
+    }
+
     Print("=== 开始VC环境配置测试 ===");
     Print("获取VC环境变量...");
 
+    traceMarkers_.clear();
+    configMarkers_ = 0;
+    taskStartMs_ = QDateTime::currentMSecsSinceEpoch();
     DisableBtn();
-    buildFile_ = buildDir + "/build.ninja";
+    buildFile_ = CMakeArgs::ninjaFile(ui->edBuildDir->text().trimmed(), ui->cbType->currentText(), ui->cbMode->currentText());
     curEnvBatFile_ = envBat;
     QFuture<QProcessEnvironment> future = QtConcurrent::run([&]() { return getVCEnvironment(curEnvBatFile_); });
 
@@ -608,11 +743,10 @@ void CmakeBuilder::cmakeConfigWithVCEnv()
 void CmakeBuilder::onVCEnvReady()
 {
     Print("VC环境变量获取成功");
+    Mark("捕获 VC 环境", "lifecycle", taskStartMs_, QDateTime::currentMSecsSinceEpoch(), curEnvBatFile_);
 
-    auto buildDir = ui->edBuildDir->text().trimmed();
+    auto buildDir = CurrentBuildTree();
     auto cmake = ui->edCMake->text().trimmed();
-    auto sourceDir = ui->edSource->text().trimmed();
-    auto generator = ui->cbType->currentText();
     auto mode = ui->cbMode->currentText();
 
     // 2. 创建构建目录
@@ -625,35 +759,36 @@ void CmakeBuilder::onVCEnvReady()
     }
 
     process_->setWorkingDirectory(buildDir);
+    // 跳过配置时后续构建同样需要 VC 环境，先于跳过检查设置
+    process_->setProcessEnvironment(curEnvValue_);
 
     // 3. 构建CMake参数
-    QStringList arguments;
-    arguments << "-S" << sourceDir;
-    arguments << "-B" << buildDir;
-    arguments << "-G" << generator;
-    arguments << "-DCMAKE_BUILD_TYPE=" + mode;
-    arguments << "-DCMAKE_EXPORT_COMPILE_COMMANDS:BOOL=TRUE";
-    arguments << "-Wno-dev";
-    arguments << "--no-warn-unused-cli";
-
-    QStringList additionalArgs = QStringList::fromVector(getAddArgsFromTable(curEnvValue_));
+    OneConfig o = CurrentJobConfig();
+    QStringList arguments = CMakeArgs::configure(o, mode, curEnvValue_);
+    QStringList additionalArgs = CMakeArgs::additional(o, mode, curEnvValue_);
     if (!additionalArgs.isEmpty()) {
-        arguments << additionalArgs;
         Print("生成的CMake参数: " + additionalArgs.join(" "));
     }
+    for (const QString& warning : CMakeArgs::configureWarnings(o, mode, curEnvValue_)) {
+        Print(warning);
+    }
+    if (SkipConfigure(buildDir, cmake, arguments, curEnvValue_)) {
+        EnableBtn();
+        return;
+    }
+    arguments << ProfileArguments(buildDir);
 
     Print("命令: " + cmake + " " + arguments.join(" "));
     Print("工作目录: " + buildDir);
     Print(SL);
 
     DisableBtn();
+    PrepareHistory("configure", mode, QString());
+    taskStartMs_ = QDateTime::currentMSecsSinceEpoch();
+    jobs_->setExternalTask(buildDir, 1);
     process_->start(cmake, arguments);
 
     currentTaskName_ = "config";
-    if (!process_->waitForStarted(5000)) {
-        Print("错误：启动配置进程超时", true);
-        return;
-    }
 }
 
 QProcessEnvironment CmakeBuilder::getVCEnvironment(const QString& vcvarsPath)
@@ -662,97 +797,19 @@ QProcessEnvironment CmakeBuilder::getVCEnvironment(const QString& vcvarsPath)
         return curEnvValue_;
     }
 
-    QProcess process;
-    process.setProgram("cmd.exe");
-    process.setArguments({"/c", "call", vcvarsPath, "&&", "set"});
     sigPrint("获取VC环境变量: " + vcvarsPath);
-    process.start();
-
-    if (!process.waitForFinished(15000)) {
-        sigPrint("错误：进程执行超时");
-        return QProcessEnvironment();
-    }
-
-    if (process.exitCode() != 0) {
-        sigPrint("错误：VC环境脚本执行失败");
-        return QProcessEnvironment();
-    }
-
-    QString allOutput = QString::fromLocal8Bit(process.readAllStandardOutput());
-
-    if (allOutput.isEmpty()) {
-        sigPrint("错误：没有获取到输出");
+    QString error;
+    QProcessEnvironment env = VcEnvironment::capture(vcvarsPath, &error);
+    if (env.isEmpty()) {
+        sigPrint("错误：" + error);
         return QProcessEnvironment();
     }
     sigPrint("成功获取VC环境变量");
     curVcEnv_ = vcvarsPath;
-    curEnvValue_ = parseEnvironmentOutput(allOutput);
-    process_->setProcessEnvironment(curEnvValue_);
+    curEnvValue_ = env;
     return curEnvValue_;
 }
 
-QProcessEnvironment CmakeBuilder::parseEnvironmentOutput(const QString& output)
-{
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    QStringList lines = output.split('\n');
-
-    for (const QString& line : lines) {
-        QString trimmedLine = line.trimmed();
-        if (trimmedLine.isEmpty())
-            continue;
-
-        int equalsIndex = trimmedLine.indexOf('=');
-        if (equalsIndex > 0) {
-            QString varName = trimmedLine.left(equalsIndex).trimmed();
-            QString varValue = trimmedLine.mid(equalsIndex + 1).trimmed();
-            env.insert(varName, varValue);
-        }
-    }
-
-    // QStringList keys = env.keys();
-    // keys.sort();
-    // sigPrint("环境变量数量: " + QString::number(keys.size()));
-    // for (const QString& key : keys) {
-    //     QString value = env.value(key);
-    //     sigPrint(key + " = " + value);
-    // }
-
-    return env;
-}
-
-QString CmakeBuilder::expandEnvVar(const QProcessEnvironment& env, const QString& str)
-{
-    QString result = str;
-
-    // 展开 %VAR% 格式的环境变量（Windows）
-    QRegularExpression winRe("%([^%]+)%");
-    QRegularExpressionMatchIterator winIt = winRe.globalMatch(str);
-    while (winIt.hasNext()) {
-        QRegularExpressionMatch match = winIt.next();
-        QString varName = match.captured(1);
-        if (env.contains(varName)) {
-            result.replace("%" + varName + "%", env.value(varName));
-        }
-    }
-
-    // 展开 $VAR 或 ${VAR} 格式的环境变量（Unix）
-    QRegularExpression unixRe("\\$(?:{([^}]+)}|(\\w+))");
-    QRegularExpressionMatchIterator unixIt = unixRe.globalMatch(str);
-    while (unixIt.hasNext()) {
-        QRegularExpressionMatch match = unixIt.next();
-        QString varName = match.captured(1).isEmpty() ? match.captured(2) : match.captured(1);
-        if (env.contains(varName)) {
-            if (match.captured(0).startsWith("${")) {
-                result.replace("${" + varName + "}", env.value(varName));
-            } else {
-                result.replace("$" + varName, env.value(varName));
-            }
-        }
-    }
-
-    return result;
-}
-
 void CmakeBuilder::onTableContextMenu(const QPoint& pos)
 {
     QMenu menu(this);
@@ -877,43 +934,6 @@ void CmakeBuilder::clearTable()
     ui->tableWidget->setRowCount(0);
 }
 
-QVector<QString> CmakeBuilder::getAddArgsFromTable(const QProcessEnvironment& env)
-{
-    QVector<QString> args;
-
-    auto curMode = ui->cbMode->currentText();
-
-    for (int row = 0; row < ui->tableWidget->rowCount(); ++row) {
-        QTableWidgetItem* nameItem = ui->tableWidget->item(row, 0);
-        QTableWidgetItem* typeItem = ui->tableWidget->item(row, 1);
-        QTableWidgetItem* modeItem = ui->tableWidget->item(row, 2);
-        QTableWidgetItem* valueItem = ui->tableWidget->item(row, 3);
-
-        // 跳过空行
-        if (!nameItem || nameItem->text().isEmpty()) {
-            continue;
-        }
-
-        if (modeItem->text() != "All" && modeItem->text() != curMode) {
-            continue;
-        }
-
-        QString name = nameItem->text().trimmed();
-        QString value = valueItem ? valueItem->text().trimmed() : "";
-
-        // 展开环境变量
-        value = expandEnvVar(env, value);
-
-        // 构建 CMake 参数
-        if (!value.isEmpty()) {
-            QString arg = "-D" + name + ":" + typeItem->text() + "=" + value;
-            args << arg;
-        }
-    }
-
-    return args;
-}
-
 void CmakeBuilder::cmakeBuild()
 {
     if (ui->cbTarget->currentText().isEmpty()) {
@@ -921,16 +941,21 @@ void CmakeBuilder::cmakeBuild()
         return;
     }
 
-    auto buildDir = ui->edBuildDir->text().trimmed();
+    auto buildDir = CurrentBuildTree();
     auto cmake = ui->edCMake->text().trimmed();
     auto target = ui->cbTarget->currentText();
     auto mode = ui->cbMode->currentText();
 
-    if (process_->state() == QProcess::Running) {
+    if (process_->isRunning()) {
         Print("CMake 进程正在运行，请等待完成...", true);
         return;
     }
 
+    if (jobs_->isDirBusy(buildDir)) {
+        Print("队列中的任务正在使用该构建目录，请等待完成...", true);
+        return;
+    }
+
     if (!QDir(buildDir).exists()) {
         Print("错误：构建目录不存在，请先执行配置", true);
         return;
@@ -941,16 +966,21 @@ void CmakeBuilder::cmakeBuild()
         return;
     }
 
-    ui->pedOutput->clear();
+    ClearOutput();
     process_->setWorkingDirectory(buildDir);
-
-    QStringList arguments;
-    arguments << "--build" << buildDir;
-    arguments << "--config" << mode;
-
-    auto retTarget = QFileInfo(target).baseName();
-    arguments << "--target" << retTarget;
-    arguments << "--parallel";
+    buildTree_ = buildDir;
+    ninjaLogOffset_ = QFileInfo(buildDir + "/.ninja_log").size();
+    // 保留之前配置阶段的标记，丢弃上一次构建的
+    traceMarkers_.resize(configMarkers_);
+    lastReport_ = BuildReport();
+    traceInfo_.clear();
+    traceInfo_.insert("project", ui->cbProject->currentText().trimmed());
+    traceInfo_.insert("generator", ui->cbType->currentText());
+    traceInfo_.insert("mode", mode);
+    traceInfo_.insert("target", target);
+    traceInfo_.insert("buildTree", buildDir);
+
+    QStringList arguments = CMakeArgs::build(CurrentJobConfig(), mode, target);
 
     Print("开始执行 CMake 构建...");
     Print("命令: " + cmake + " " + arguments.join(" "));
@@ -959,13 +989,18 @@ void CmakeBuilder::cmakeBuild()
     Print("工作目录: " + buildDir);
     Print(SL);
 
+    // ninja 状态行改为可解析的格式，由 I/O 线程折叠为进度条
+    process_->setProcessEnvironment(CMakeArgs::buildEnvironment(process_->processEnvironment()));
+    ResetProgress();
+
     DisableBtn();
+    PrepareHistory("build", mode, target);
+    taskStartMs_ = QDateTime::currentMSecsSinceEpoch();
+    // 未指定 --parallel，ninja 会用满所有核心
+    jobs_->setExternalTask(buildDir, jobs_->coreBudget());
     process_->start(cmake, arguments);
 
-    if (!process_->waitForStarted(5000)) {
-        Print("错误：启动 CMake 构建进程超时", true);
-        return;
-    }
+    currentTaskName_ = "build";
 }
 
 void CmakeBuilder::DisableBtn()
@@ -1018,112 +1053,598 @@ void CmakeBuilder::EnableBtn()
 
 void CmakeBuilder::onProcessReadyRead()
 {
-    QByteArray outputData = process_->readAllStandardOutput();
-    if (!outputData.isEmpty()) {
-        static QString stdoutBuffer;
-        stdoutBuffer.append(QString::fromLocal8Bit(outputData));
+    QVector<OutputLine> lines;
+    process_->takeLines(lines);
+    for (const OutputLine& line : lines) {
+        if (line.hidden) {
+            AddDuplicateDiagnostic(line.diag);
+            continue;
+        }
+        int logLine = logSink_->append(line.text, line.isError, line.time, line.styles);
+        if (line.diag.severity != Diagnostic::None && logLine >= 0) {
+            Diagnostic diag = line.diag;
+            diag.logLine = logLine;
+            AddDiagnostic(diag);
+        }
+    }
+    UpdateSearch();
+}
 
-        // 手动按换行符分割
-        int newlinePos;
-        while ((newlinePos = stdoutBuffer.indexOf('\n')) != -1) {
-            QString line = stdoutBuffer.left(newlinePos).trimmed();
-            stdoutBuffer = stdoutBuffer.mid(newlinePos + 1);
+void CmakeBuilder::InitDiagPanel()
+{
+    ui->twDiag->setColumnCount(3);
+    ui->twDiag->setRootIsDecorated(true);
+    ui->twDiag->setUniformRowHeights(true);
+    ui->twDiag->setColumnWidth(0, 320);
+    ui->splitOutput->setStretchFactor(0, 3);
+    ui->splitOutput->setStretchFactor(1, 1);
+
+    // 点击诊断直接跳到日志中的对应行
+    connect(ui->twDiag, &QTreeWidget::itemClicked, this, [this](QTreeWidgetItem* item, int column) {
+        Q_UNUSED(column);
+        int index = item->data(0, Qt::UserRole).toInt();
+        if (index >= 0 && index < diagIndex_.count()) {
+            ui->pedOutput->scrollToLine(diagIndex_.at(index).logLine);
+        }
+    });
+}
 
-            if (!line.isEmpty()) {
-#if defined(_WIN32)
-                line = code_handle(line);
-#endif
-                Print(line, false);
-            }
+void CmakeBuilder::AddDiagnostic(const Diagnostic& diag)
+{
+    int index = diagIndex_.add(diag);
+
+    QStringList columns;
+    columns << DiagnosticParser::severityName(diag.severity) + ": " + diag.message;
+    columns << (diag.line > 0 ? diag.file + ":" + QString::number(diag.line) : diag.file);
+    columns << (diag.group >= 0 ? "1" : "");
+
+    QTreeWidgetItem* item = new QTreeWidgetItem(columns);
+    item->setData(0, Qt::UserRole, index);
+    item->setToolTip(0, diag.message);
+    item->setToolTip(1, diag.file);
+    if (diag.severity == Diagnostic::Error) {
+        item->setForeground(0, QBrush(QColor(200, 0, 0)));
+    } else if (diag.severity == Diagnostic::Warning) {
+        item->setForeground(0, QBrush(QColor(200, 120, 0)));
+    }
+
+    // note 挂在前一条错误或警告下面
+    int top = ui->twDiag->topLevelItemCount();
+    if (diag.severity == Diagnostic::Note && top > 0) {
+        ui->twDiag->topLevelItem(top - 1)->addChild(item);
+    } else {
+        ui->twDiag->addTopLevelItem(item);
+    }
+    if (diag.group >= 0) {
+        diagItems_.insert(diag.group, item);
+    }
+    UpdateDiagHeader();
+}
+
+void CmakeBuilder::AddDuplicateDiagnostic(const Diagnostic& diag)
+{
+    // 重复诊断只更新所在分组的一行：次数和涉及的编译单元
+    const DiagnosticGroup* group = diagIndex_.addDuplicate(diag);
+    QTreeWidgetItem* item = diagItems_.value(diag.group);
+    if (!group || !item) {
+        return;
+    }
+    item->setText(2, QString::number(group->count));
+
+    constexpr int maxUnits = 20;
+    QStringList units = group->units.mid(0, maxUnits);
+    QString tip = "涉及的编译单元：\n" + units.join("\n");
+    if (group->units.size() > maxUnits) {
+        tip += QString("\n... 共 %1 个").arg(group->units.size());
+    }
+    item->setToolTip(2, tip);
+    UpdateDiagHeader();
+}
+
+void CmakeBuilder::UpdateDiagHeader()
+{
+    QString text = QString("诊断（错误 %1，警告 %2").arg(diagIndex_.count(Diagnostic::Error)).arg(diagIndex_.count(Diagnostic::Warning));
+    if (diagIndex_.duplicates() > 0) {
+        text += QString("，折叠重复 %1").arg(diagIndex_.duplicates());
+    }
+    ui->twDiag->headerItem()->setText(0, text + "）");
+}
+
+void CmakeBuilder::InitReportPanel()
+{
+    ui->twReport->setColumnCount(3);
+    ui->twReport->setUniformRowHeights(true);
+    ui->twReport->setColumnWidth(0, 480);
+
+    ui->twReport->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->twReport, &QWidget::customContextMenuRequested, this, [this](const QPoint& pos) {
+        QMenu menu(this);
+        QAction* exportAction = menu.addAction("导出 Chrome 跟踪 (JSON)...");
+        exportAction->setEnabled(!lastReport_.edges.isEmpty());
+        if (menu.exec(ui->twReport->viewport()->mapToGlobal(pos)) == exportAction) {
+            ExportTrace();
         }
+    });
+}
+
+void CmakeBuilder::Mark(const QString& name, const QString& category, qint64 startMs, qint64 endMs, const QString& detail)
+{
+    BuildTrace::Marker marker;
+    marker.name = name;
+    marker.category = category;
+    marker.startMs = startMs;
+    marker.endMs = endMs;
+    marker.detail = detail;
+    traceMarkers_.append(marker);
+}
 
-        // stdoutBuffer 中保留的是不完整的行
+void CmakeBuilder::ExportTrace()
+{
+    if (lastReport_.edges.isEmpty()) {
+        QMessageBox::information(this, "提示", "没有可导出的构建");
+        return;
     }
+    QString file = QFileDialog::getSaveFileName(this, "导出 Chrome 跟踪", QDir(buildTree_).filePath("cmakebuilder-trace.json"),
+                                                "Chrome 跟踪 (*.json)");
+    if (file.isEmpty()) {
+        return;
+    }
+    QString error;
+    if (!BuildTrace::write(file, lastReport_, buildStartMs_, traceMarkers_, traceInfo_, error)) {
+        Print("错误：导出跟踪失败: " + error, true);
+        return;
+    }
+    Print("已导出跟踪: " + file + "，可在 Perfetto（ui.perfetto.dev）或 chrome://tracing 中打开");
+}
 
-    // 处理标准错误（和标准输出一样的方案3）
-    QByteArray errorData = process_->readAllStandardError();
-    if (!errorData.isEmpty()) {
-        static QString stderrBuffer;
-        stderrBuffer.append(QString::fromLocal8Bit(errorData));
+void CmakeBuilder::AnalyzeBuild(const HistoryRecord& record)
+{
+    // build.ninja 可能有几十 MB，在线程池中解析
+    QString tree = buildTree_;
+    QString ninjaFile = buildFile_;
+    qint64 offset = ninjaLogOffset_;
+    qint64 start = QDateTime::currentMSecsSinceEpoch();
+    QFutureWatcher<BuildReport>* watcher = new QFutureWatcher<BuildReport>(this);
+    connect(watcher, &QFutureWatcher<BuildReport>::finished, this, [this, watcher, start, record]() {
+        Mark("构建分析", "lifecycle", start, QDateTime::currentMSecsSinceEpoch());
+        ShowBuildReport(watcher->result());
+        RecordHistory(record, lastReport_);
+        watcher->deleteLater();
+        // 编译耗时跟踪的结果追加在构建分析之后
+        if (ui->ckTimeTrace->isChecked()) {
+            AnalyzeTimeTrace();
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([tree, ninjaFile, offset]() { return NinjaLog::analyze(tree, ninjaFile, offset); }));
+}
 
-        // 手动按换行符分割处理
-        int newlinePos;
-        while ((newlinePos = stderrBuffer.indexOf('\n')) != -1) {
-            QString line = stderrBuffer.left(newlinePos).trimmed();
-            stderrBuffer = stderrBuffer.mid(newlinePos + 1);
+void CmakeBuilder::PrepareHistory(const QString& kind, const QString& mode, const QString& target)
+{
+    pendingHistory_ = HistoryRecord();
+    pendingHistory_.kind = kind;
+    pendingHistory_.project = ui->cbProject->currentText().trimmed();
+    pendingHistory_.mode = mode;
+    pendingHistory_.target = target;
+    pendingHistory_.generator = ui->cbType->currentText();
+    pendingHistory_.commit = BuildHistory::gitHead(ui->edSource->text().trimmed());
+}
 
-            if (!line.isEmpty()) {
-#if defined(_WIN32)
-                line = code_handle(line);
-#endif
-                Print(line, true);   // 第二个参数为true，表示错误输出
-            }
+void CmakeBuilder::RecordHistory(HistoryRecord record, const BuildReport& report)
+{
+    record.time = QDateTime::currentMSecsSinceEpoch();
+    if (report.valid) {
+        record.cpuMs = report.cpuMs;
+        record.edges = report.edges.size();
+        record.parallelism = report.parallelism;
+        record.criticalMs = report.criticalMs;
+    }
+    QString error;
+    if (!history_->append(record, report.valid ? report.edges : QVector<NinjaEdge>(), error)) {
+        Print("错误：写入构建历史失败: " + error, true);
+        return;
+    }
+    if (!record.success) {
+        return;
+    }
+
+    QVector<HistoryRecord> records = history_->load(record.project);
+    if (records.isEmpty()) {
+        return;
+    }
+    qint64 base = BuildHistory::baseline(records, records.size() - 1);
+    if (BuildHistory::isRegression(record.wallMs, base)) {
+        Print(QString("警告：本次%1耗时 %2 s，比最近的基线 %3 s 慢 %4%（提交 %5），可在“历史”中比较")
+                  .arg(record.kind == "build" ? "构建" : "配置")
+                  .arg(record.wallMs / 1000.0, 0, 'f', 2)
+                  .arg(base / 1000.0, 0, 'f', 2)
+                  .arg(100.0 * (record.wallMs - base) / base, 0, 'f', 0)
+                  .arg(record.commit.isEmpty() ? QString("-") : record.commit),
+              true);
+    }
+}
+
+void CmakeBuilder::AnalyzeConfigProfile()
+{
+    QString file = profileFile_;
+    QString previous = ConfigProfile::previousFile(configTree_);
+    profileFile_.clear();
+    qint64 start = QDateTime::currentMSecsSinceEpoch();
+    typedef QPair<ConfigProfileReport, ConfigProfileReport> Reports;
+    QFutureWatcher<Reports>* watcher = new QFutureWatcher<Reports>(this);
+    connect(watcher, &QFutureWatcher<Reports>::finished, this, [this, watcher, start]() {
+        Mark("配置性能分析", "lifecycle", start, QDateTime::currentMSecsSinceEpoch());
+        Reports reports = watcher->result();
+        ShowConfigProfile(reports.first, reports.second);
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([file, previous]() {
+        ConfigProfileReport prev;
+        if (QFile::exists(previous)) {
+            prev = ConfigProfile::analyze(previous);
+        }
+        return Reports(ConfigProfile::analyze(file), prev);
+    }));
+}
+
+void CmakeBuilder::ShowConfigProfile(const ConfigProfileReport& report, const ConfigProfileReport& previous)
+{
+    if (!report.valid) {
+        Print("配置性能分析：" + report.error, true);
+        return;
+    }
+
+    ui->twReport->clear();
+    ui->twReport->headerItem()->setText(2, previous.valid ? "较上次 (s)" : QString());
+    auto seconds = [](qint64 us) { return QString::number(us / 1000000.0, 'f', 2); };
+    auto delta = [&previous, &seconds](qint64 us, qint64 before) -> QString {
+        if (!previous.valid) {
+            return QString();
         }
+        return (us >= before ? "+" : "-") + seconds(qAbs(us - before));
+    };
+    auto addRow = [](QTreeWidgetItem* parent, const QString& name, const QString& time, const QString& diff) -> QTreeWidgetItem* {
+        QTreeWidgetItem* item = new QTreeWidgetItem(parent, QStringList{name, time, diff});
+        item->setTextAlignment(1, Qt::AlignRight | Qt::AlignVCenter);
+        item->setTextAlignment(2, Qt::AlignRight | Qt::AlignVCenter);
+        return item;
+    };
+
+    QTreeWidgetItem* root = new QTreeWidgetItem(QStringList{QString("配置耗时（%1 次命令调用）").arg(report.events),
+                                                            seconds(report.totalUs), delta(report.totalUs, previous.totalUs)});
+    QFont font = root->font(0);
+    font.setBold(true);
+    root->setFont(0, font);
+    root->setTextAlignment(1, Qt::AlignRight | Qt::AlignVCenter);
+    root->setTextAlignment(2, Qt::AlignRight | Qt::AlignVCenter);
+    ui->twReport->addTopLevelItem(root);
+
+    QStringList summary;
+    for (const QString& command : ConfigProfile::watchedCommands()) {
+        ConfigProfileItem total = report.commands.value(command);
+        ConfigProfileItem before = previous.commands.value(command);
+        QTreeWidgetItem* group = addRow(root, QString("%1（%2 次）").arg(command).arg(total.count), seconds(total.totalUs),
+                                        delta(total.totalUs, before.totalUs));
+        group->setFont(0, font);
+
+        // 与上次按同一调用比较
+        QHash<QString, qint64> beforeCalls;
+        for (const ConfigProfileItem& item : previous.slowest.value(command)) {
+            beforeCalls.insert(item.call, item.totalUs);
+        }
+        for (const ConfigProfileItem& item : report.slowest.value(command)) {
+            QString diff = beforeCalls.contains(item.call) ? delta(item.totalUs, beforeCalls.value(item.call)) : QString();
+            QTreeWidgetItem* row = addRow(group, QString("%1（%2 次）").arg(item.call).arg(item.count), seconds(item.totalUs), diff);
+            row->setToolTip(0, "最慢一次: " + item.location);
+        }
+        if (total.count > 0) {
+            summary << QString("%1 %2 次 %3 s").arg(command).arg(total.count).arg(seconds(total.totalUs));
+        }
+    }
+
+    // 所有命令中总耗时最多的，包括 project、add_subdirectory 等
+    QVector<ConfigProfileItem> commands;
+    for (auto it = report.commands.constBegin(); it != report.commands.constEnd(); ++it) {
+        commands.append(it.value());
+    }
+    std::sort(commands.begin(), commands.end(),
+              [](const ConfigProfileItem& a, const ConfigProfileItem& b) { return a.totalUs > b.totalUs; });
+    QTreeWidgetItem* all = addRow(root, "耗时最多的命令（含嵌套调用）", QString(), QString());
+    all->setFont(0, font);
+    for (int i = 0; i < commands.size() && i < 10; ++i) {
+        const ConfigProfileItem& c = commands.at(i);
+        addRow(all, QString("%1（%2 次）").arg(c.command).arg(c.count), seconds(c.totalUs),
+               delta(c.totalUs, previous.commands.value(c.command).totalUs));
+    }
+    ui->twReport->expandAll();
 
-        // stderrBuffer 自动保留不完整的行
+    QString text = "配置性能分析：总 " + seconds(report.totalUs) + " s";
+    if (previous.valid) {
+        text += "（较上次 " + delta(report.totalUs, previous.totalUs) + " s）";
+    }
+    if (!summary.isEmpty()) {
+        text += "，" + summary.join("，");
     }
+    Print(text + "，详见“构建分析”页");
 }
 
-void CmakeBuilder::Print(const QString& text, bool isError)
+void CmakeBuilder::AnalyzeTimeTrace()
 {
-    if (text.isEmpty()) {
+    QString tree = buildTree_;
+    qint64 start = QDateTime::currentMSecsSinceEpoch();
+    QFutureWatcher<TimeTraceReport>* watcher = new QFutureWatcher<TimeTraceReport>(this);
+    connect(watcher, &QFutureWatcher<TimeTraceReport>::finished, this, [this, watcher, start]() {
+        Mark("汇总编译耗时跟踪", "lifecycle", start, QDateTime::currentMSecsSinceEpoch());
+        ShowTimeTrace(watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([tree]() { return TimeTrace::aggregate(tree); }));
+}
+
+void CmakeBuilder::ShowTimeTrace(const TimeTraceReport& report)
+{
+    if (report.units == 0) {
+        Print("编译耗时跟踪：构建树中没有 -ftime-trace 生成的跟踪文件（仅 Clang 支持，开启后需重新配置并编译）");
         return;
     }
 
-    QString processedText = text;
-    QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss.zzz");
+    auto seconds = [](qint64 us) { return QString::number(us / 1000000.0, 'f', 2); };
+    QTreeWidgetItem* root = new QTreeWidgetItem(QStringList{
+        QString("编译耗时跟踪（%1 个编译单元，%2 MB）").arg(report.units).arg(report.bytes / (1024.0 * 1024.0), 0, 'f', 1)});
+    QFont font = root->font(0);
+    font.setBold(true);
+    root->setFont(0, font);
+    ui->twReport->addTopLevelItem(root);
+
+    new QTreeWidgetItem(root, QStringList{"编译总耗时", seconds(report.compileUs)});
+    new QTreeWidgetItem(root, QStringList{"前端（解析、模板实例化）", seconds(report.frontendUs)});
+    new QTreeWidgetItem(root, QStringList{"后端（优化、代码生成）", seconds(report.backendUs)});
+    auto addItems = [root, &seconds](const QString& title, const QVector<TimeTraceItem>& items) {
+        QTreeWidgetItem* group = new QTreeWidgetItem(root, QStringList{title});
+        for (const TimeTraceItem& t : items) {
+            QTreeWidgetItem* item =
+                new QTreeWidgetItem(group, QStringList{QString("%1（%2 次）").arg(t.name).arg(t.count), seconds(t.totalUs)});
+            item->setToolTip(0, t.name);
+            item->setTextAlignment(1, Qt::AlignRight | Qt::AlignVCenter);
+        }
+    };
+    addItems("最耗时的头文件（含嵌套包含）", report.includes);
+    addItems("最耗时的模板（按模板名合并）", report.templateSets);
+    addItems("最耗时的模板实例化", report.templates);
+    addItems("最慢的编译单元", report.slowestUnits);
+    root->setExpanded(true);
+    for (int i = 0; i < root->childCount(); ++i) {
+        root->child(i)->setExpanded(true);
+    }
+
+    QString text = QString("编译耗时跟踪：%1 个编译单元，前端 %2 s，后端 %3 s")
+                       .arg(report.units)
+                       .arg(seconds(report.frontendUs))
+                       .arg(seconds(report.backendUs));
+    if (!report.includes.isEmpty()) {
+        text += "，最耗时的头文件 " + QFileInfo(report.includes.first().name).fileName();
+    }
+    if (report.failed > 0) {
+        text += QString("，%1 个跟踪文件无法解析").arg(report.failed);
+    }
+    Print(text);
+}
 
-    QTextCursor cursor = ui->pedOutput->textCursor();
-    cursor.movePosition(QTextCursor::End);
+void CmakeBuilder::ShowBuildReport(const BuildReport& report)
+{
+    lastReport_ = report;
+    ui->twReport->clear();
+    ui->twReport->headerItem()->setText(2, "开始 (s)");
+    if (!report.valid) {
+        Print("构建分析：" + report.error);
+        return;
+    }
+    if (report.edges.isEmpty()) {
+        Print("构建分析：本次构建没有执行任何步骤");
+        return;
+    }
 
-    QTextCharFormat timeFormat;
-    timeFormat.setForeground(QBrush(QColor(128, 128, 128)));   // 灰色时间戳
-    timeFormat.setFontWeight(QFont::Normal);
-    cursor.setCharFormat(timeFormat);
-    cursor.insertText("[" + timestamp + "] ");
+    auto seconds = [](qint64 ms) { return QString::number(ms / 1000.0, 'f', 2); };
+    auto addGroup = [this](const QString& title) -> QTreeWidgetItem* {
+        QTreeWidgetItem* item = new QTreeWidgetItem(QStringList{title});
+        QFont font = item->font(0);
+        font.setBold(true);
+        item->setFont(0, font);
+        ui->twReport->addTopLevelItem(item);
+        return item;
+    };
+    auto addEdges = [&report, &seconds](QTreeWidgetItem* parent, const QVector<int>& indexes) {
+        for (int index : indexes) {
+            const NinjaEdge& edge = report.edges.at(index);
+            QString name = edge.outputs.first();
+            if (edge.outputs.size() > 1) {
+                name += QString("（等 %1 个输出）").arg(edge.outputs.size());
+            }
+            QTreeWidgetItem* item = new QTreeWidgetItem(parent, QStringList{name, seconds(edge.duration()), seconds(edge.start)});
+            item->setToolTip(0, edge.outputs.join("\n") + (edge.rule.isEmpty() ? QString() : "\n规则: " + edge.rule));
+            item->setTextAlignment(1, Qt::AlignRight | Qt::AlignVCenter);
+            item->setTextAlignment(2, Qt::AlignRight | Qt::AlignVCenter);
+        }
+    };
 
-    // 2. 插入内容文本
-    QTextCharFormat contentFormat;
-    // if (isError) {
-    //     contentFormat.setForeground(QBrush(QColor(200, 0, 0)));   //
-    //     深红色错误信息 contentFormat.setFontWeight(QFont::Bold);
-    // } else {
-    contentFormat.setForeground(QBrush(QColor(0, 0, 0)));   // 黑色普通信息
-    contentFormat.setFontWeight(QFont::Normal);
-    //}
-    cursor.setCharFormat(contentFormat);
-    cursor.insertText(processedText + "\n");
+    int compiles = 0;
+    int links = 0;
+    for (const NinjaEdge& edge : report.edges) {
+        compiles += edge.kind == NinjaEdge::Compile ? 1 : 0;
+        links += edge.kind == NinjaEdge::Link ? 1 : 0;
+    }
+    QTreeWidgetItem* summary = addGroup("概要");
+    new QTreeWidgetItem(summary, QStringList{"墙钟时间", seconds(report.wallMs)});
+    new QTreeWidgetItem(summary, QStringList{"CPU 时间（各步骤耗时之和）", seconds(report.cpuMs)});
+    new QTreeWidgetItem(summary, QStringList{"平均并行度", QString::number(report.parallelism, 'f', 2)});
+    new QTreeWidgetItem(summary, QStringList{QString("执行的步骤 %1 个（编译 %2，链接 %3）").arg(report.edges.size()).arg(compiles).arg(links)});
+
+    QString pathText = "关键路径：未能读取依赖图";
+    if (!report.criticalPath.isEmpty()) {
+        pathText = QString("关键路径（%1 步，%2 s，占墙钟 %3%）")
+                       .arg(report.criticalPath.size())
+                       .arg(seconds(report.criticalMs))
+                       .arg(report.wallMs > 0 ? 100 * report.criticalMs / report.wallMs : 0);
+    }
+    addEdges(addGroup(pathText), report.criticalPath);
+    addEdges(addGroup(QString("最慢的编译（前 %1）").arg(report.slowestCompile.size())), report.slowestCompile);
+    addEdges(addGroup(QString("最慢的链接（前 %1）").arg(report.slowestLink.size())), report.slowestLink);
+    ui->twReport->expandAll();
+
+    Print(QString("构建分析：%1 个步骤，墙钟 %2 s，CPU %3 s，并行度 %4，关键路径 %5 s，详见“构建分析”页（右键可导出 Chrome 跟踪）")
+              .arg(report.edges.size())
+              .arg(seconds(report.wallMs))
+              .arg(seconds(report.cpuMs))
+              .arg(report.parallelism, 0, 'f', 2)
+              .arg(seconds(report.criticalMs)));
+}
 
-    // 自动滚动到底部
-    // ui->pedOutput->ensureCursorVisible();
-    QScrollBar* vScrollBar = ui->pedOutput->verticalScrollBar();
-    vScrollBar->setValue(vScrollBar->maximum());
+void CmakeBuilder::ClearOutput()
+{
+    logSink_->clear();
+    diagIndex_.clear();
+    diagItems_.clear();
+    ui->twDiag->clear();
+    ui->twDiag->headerItem()->setText(0, "诊断");
+    searchHits_.clear();
+    searchedTo_ = 0;
+    searchPos_ = -1;
+    UpdateSearch();
 }
 
-QVector<QString> CmakeBuilder::getTarget()
+void CmakeBuilder::InitSearch()
 {
-    QVector<QString> targetFiles;
-    QFile file(buildFile_);
+    auto* findShortcut = new QShortcut(QKeySequence::Find, this);
+    connect(findShortcut, &QShortcut::activated, this, [this]() {
+        ui->leSearch->setFocus();
+        ui->leSearch->selectAll();
+    });
+    auto* nextShortcut = new QShortcut(QKeySequence::FindNext, this);
+    connect(nextShortcut, &QShortcut::activated, this, [this]() { SearchStep(1); });
+    auto* prevShortcut = new QShortcut(QKeySequence::FindPrevious, this);
+    connect(prevShortcut, &QShortcut::activated, this, [this]() { SearchStep(-1); });
+
+    connect(ui->leSearch, &QLineEdit::textChanged, this, &CmakeBuilder::RunSearch);
+    connect(ui->leSearch, &QLineEdit::returnPressed, this, [this]() { SearchStep(1); });
+    connect(ui->cbSearchRegex, &QCheckBox::toggled, this, &CmakeBuilder::RunSearch);
+    connect(ui->cbSearchCase, &QCheckBox::toggled, this, &CmakeBuilder::RunSearch);
+    connect(ui->btnSearchNext, &QPushButton::clicked, this, [this]() { SearchStep(1); });
+    connect(ui->btnSearchPrev, &QPushButton::clicked, this, [this]() { SearchStep(-1); });
+}
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        return targetFiles;
+void CmakeBuilder::RunSearch()
+{
+    searchQuery_.text = ui->leSearch->text();
+    searchQuery_.regex = ui->cbSearchRegex->isChecked();
+    searchQuery_.caseSensitive = ui->cbSearchCase->isChecked();
+    searchHits_.clear();
+    searchedTo_ = 0;
+    searchPos_ = -1;
+    searchValid_ = true;
+    UpdateSearch();
+    if (!searchHits_.isEmpty()) {
+        SearchStep(1);
     }
+}
 
-    QTextStream stream(&file);
-    QString content = stream.readAll();
-    file.close();
+void CmakeBuilder::UpdateSearch()
+{
+    // 构建仍在输出时只检索新追加的行，已有结果保持不变
+    const LogStore* store = ui->pedOutput->store();
+    if (!searchQuery_.text.isEmpty() && searchValid_ && searchedTo_ < store->lineCount()) {
+        searchValid_ = store->search(searchQuery_, searchedTo_, store->lineCount(), searchHits_);
+        searchedTo_ = store->lineCount();
+    }
 
-    // 使用正则表达式匹配所有 TARGET_FILE = 行
-    QRegularExpression regex(R"(TARGET_FILE\s*=\s*([^\s]+))");
-    QRegularExpressionMatchIterator matches = regex.globalMatch(content);
+    if (searchQuery_.text.isEmpty()) {
+        ui->lbSearch->clear();
+    } else if (!searchValid_) {
+        ui->lbSearch->setText("正则表达式无效");
+    } else {
+        ui->lbSearch->setText(QString("%1/%2").arg(searchPos_ + 1).arg(searchHits_.size()));
+    }
+}
 
-    while (matches.hasNext()) {
-        QRegularExpressionMatch match = matches.next();
-        QString targetFile = match.captured(1).trimmed();
-        targetFiles.append(targetFile);
+void CmakeBuilder::SearchStep(int step)
+{
+    UpdateSearch();
+    int n = searchHits_.size();
+    if (n == 0) {
+        return;
+    }
+    if (searchPos_ < 0) {
+        searchPos_ = step > 0 ? 0 : n - 1;
+    } else {
+        searchPos_ = (searchPos_ + step + n) % n;
+    }
+    ui->pedOutput->scrollToLine(searchHits_.at(searchPos_));
+    UpdateSearch();
+}
+
+void CmakeBuilder::ResetProgress()
+{
+    progressSamples_.clear();
+    ui->pbBuild->setMaximum(100);
+    ui->pbBuild->setValue(0);
+    ui->lbProgress->clear();
+}
+
+void CmakeBuilder::onBuildProgress()
+{
+    NinjaProgress p = process_->takeProgress();
+    if (p.total <= 0) {
+        return;
+    }
+    ui->pbBuild->setMaximum(p.total);
+    ui->pbBuild->setValue(p.finished);
+
+    // 以最近约 5 秒的完成速度估算剩余时间
+    progressSamples_.append(qMakePair(p.elapsed, p.finished));
+    while (progressSamples_.size() > 2 && p.elapsed - progressSamples_.first().first > 5.0) {
+        progressSamples_.removeFirst();
+    }
+    double rate = 0;
+    double span = p.elapsed - progressSamples_.first().first;
+    if (span > 0.2) {
+        rate = (p.finished - progressSamples_.first().second) / span;
+    } else if (p.elapsed > 0) {
+        rate = p.finished / p.elapsed;
+    }
+
+    QString eta = "--:--";
+    if (rate > 0) {
+        int sec = static_cast<int>((p.total - p.finished) / rate);
+        eta = QString::asprintf("%02d:%02d", sec / 60, sec % 60);
+    }
+    ui->lbProgress->setText(QString("%1/%2  运行中: %3  速度: %4 个/秒  剩余: %5")
+                                .arg(p.finished)
+                                .arg(p.total)
+                                .arg(p.running)
+                                .arg(rate, 0, 'f', 1)
+                                .arg(eta));
+}
+
+void CmakeBuilder::Print(const QString& text, bool isError)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+    logSink_->append(text, isError);
+}
+
+QVector<QString> CmakeBuilder::getTarget()
+{
+    return CMakeArgs::readTargets(buildFile_).toVector();
+}
+
+void CmakeBuilder::onProcessStarted()
+{
+    RunStats stats = process_->runStats();
+    Print(QString("进程已启动，耗时 %1 ms").arg(stats.startMs));
+    // ninja 日志的时间以 ninja 启动为 0 点，用 cmake --build 的启动时间近似
+    Mark("进程已启动", "lifecycle", taskStartMs_ + stats.startMs);
+    if (currentTaskName_ == "build") {
+        buildStartMs_ = taskStartMs_ + stats.startMs;
     }
-    auto r = targetFiles = QSet<QString>(targetFiles.begin(), targetFiles.end()).values().toVector();
-    return targetFiles;
 }
 
 void CmakeBuilder::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
@@ -1132,16 +1653,55 @@ void CmakeBuilder::onProcessFinished(int exitCode, QProcess::ExitStatus exitStat
     onProcessReadyRead();
 
     Print(SL);
+    RunStats stats = process_->runStats();
+    if (stats.shutdownMs >= 0) {
+        static const char* stages[] = {"SIGINT", "SIGTERM", "SIGKILL"};
+        QString stage = stages[qBound(0, stats.shutdownStage, 2)];
+        if (stats.shutdownLeftover) {
+            Print(QString("等待 %1 ms（%2）后仍有子进程未退出").arg(stats.shutdownMs).arg(stage), true);
+        } else {
+#if defined(Q_OS_UNIX) && !defined(Q_OS_LINUX)
+            // 没有 /proc 进程树，只能确认 cmake/ninja 所在的进程组
+            Print(QString("cmake/ninja 进程组已退出，耗时 %1 ms（%2）").arg(stats.shutdownMs).arg(stage));
+#else
+            Print(QString("进程树已全部退出，耗时 %1 ms（%2）").arg(stats.shutdownMs).arg(stage));
+#endif
+        }
+    }
+    if (stats.firstOutputMs >= 0) {
+        Print(QString("启动耗时 %1 ms，首次输出 %2 ms").arg(stats.startMs).arg(stats.firstOutputMs));
+    } else {
+        Print(QString("启动耗时 %1 ms，无输出").arg(stats.startMs));
+    }
 
+    bool isBuild = currentTaskName_ == "build";
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (stats.firstOutputMs >= 0) {
+        Mark("首次输出", "lifecycle", taskStartMs_ + stats.firstOutputMs);
+    }
+    if (stats.shutdownMs >= 0) {
+        Mark("结束进程树", "lifecycle", now - stats.shutdownMs, now);
+    }
+    if (!currentTaskName_.isEmpty()) {
+        QString detail = exitStatus == QProcess::NormalExit ? QString("退出码 %1").arg(exitCode) : QString("异常退出");
+        Mark(isBuild ? "CMake 构建" : "CMake 配置", isBuild ? "build" : "configure", taskStartMs_, now, detail);
+        if (!isBuild) {
+            configMarkers_ = traceMarkers_.size();
+        }
+    }
     auto afterFinish = [this]() {
         std::shared_ptr<void> r(nullptr, [this](void*) { currentTaskName_.clear(); });
         if (currentTaskName_ == "config") {
+            ConfigFingerprint::save(configTree_, pendingFingerprint_);
             onBuildNinjaChanged("");
         }
     };
 
     if (exitStatus == QProcess::NormalExit) {
         if (exitCode == 0) {
+            if (currentTaskName_ == "build") {
+                ui->pbBuild->setValue(ui->pbBuild->maximum());
+            }
             Print("CMake 执行成功！");
             Print(SL);
             afterFinish();
@@ -1154,7 +1714,23 @@ void CmakeBuilder::onProcessFinished(int exitCode, QProcess::ExitStatus exitStat
         Print("CMake 进程异常退出", true);
     }
 
+    HistoryRecord record = pendingHistory_;
+    record.exitCode = exitStatus == QProcess::NormalExit ? exitCode : -1;
+    record.success = exitStatus == QProcess::NormalExit && exitCode == 0;
+    record.wallMs = now - taskStartMs_;
+    // 失败的构建同样分析已执行的部分，分析完成后再记入历史
+    if (isBuild && exitStatus == QProcess::NormalExit) {
+        AnalyzeBuild(record);
+    } else if (!record.kind.isEmpty()) {
+        RecordHistory(record, BuildReport());
+    }
+    pendingHistory_ = HistoryRecord();
+    if (!isBuild && !profileFile_.isEmpty() && exitStatus == QProcess::NormalExit) {
+        AnalyzeConfigProfile();
+    }
     EnableBtn();
+    // 指纹已保存，再放行队列中等待该构建目录的任务
+    jobs_->setExternalTask(QString(), 0);
 }
 
 void CmakeBuilder::onProcessError(QProcess::ProcessError error)
@@ -1181,5 +1757,268 @@ void CmakeBuilder::onProcessError(QProcess::ProcessError error)
     }
 
     Print("错误: " + errorMsg, true);
-    ui->btnConfig->setEnabled(true);
+    if (error == QProcess::FailedToStart) {
+        // 启动失败不会再有 finished 信号，在这里恢复界面
+        currentTaskName_.clear();
+        EnableBtn();
+        jobs_->setExternalTask(QString(), 0);
+    } else {
+        ui->btnConfig->setEnabled(true);
+    }
+}
+
+void CmakeBuilder::InitQueue()
+{
+    int cores = config_->getJobCores();
+    jobs_->setCoreBudget(cores > 0 ? cores : QThread::idealThreadCount());
+
+    // 前两页是交互式的当前输出和构建分析，不可关闭
+    ui->tabOutput->setTabsClosable(true);
+    for (int i = 0; i < 2; ++i) {
+        ui->tabOutput->tabBar()->setTabButton(i, QTabBar::RightSide, nullptr);
+        ui->tabOutput->tabBar()->setTabButton(i, QTabBar::LeftSide, nullptr);
+    }
+    connect(ui->tabOutput, &QTabWidget::tabCloseRequested, this, &CmakeBuilder::CloseJobTab);
+
+    connect(jobs_, &JobQueue::sigJobAdded, this, &CmakeBuilder::onJobAdded);
+    connect(jobs_, &JobQueue::sigJobChanged, this, &CmakeBuilder::onJobChanged);
+    connect(jobs_, &JobQueue::sigJobOutput, this, &CmakeBuilder::onJobOutput);
+    connect(jobs_, &JobQueue::sigJobProgress, this, &CmakeBuilder::onJobProgress);
+    connect(jobs_, &JobQueue::sigIdle, this, &CmakeBuilder::UpdateQueueButton);
+
+    QMenu* menu = new QMenu(this);
+    connect(menu->addAction("当前项目：配置并构建"), &QAction::triggered, this,
+            [this]() { QueueProjects({ui->cbProject->currentText().trimmed()}, false); });
+    connect(menu->addAction("当前项目：配置、构建并运行"), &QAction::triggered, this,
+            [this]() { QueueProjects({ui->cbProject->currentText().trimmed()}, true); });
+    connect(menu->addAction("选择多个项目..."), &QAction::triggered, this, &CmakeBuilder::SelectQueueProjects);
+    menu->addSeparator();
+    connect(menu->addAction("并行核心数..."), &QAction::triggered, this, [this]() {
+        bool ok = false;
+        int cores = QInputDialog::getInt(this, "并行核心数", "队列中所有任务共用的 CPU 核心数：", jobs_->coreBudget(), 1,
+                                         1024, 1, &ok);
+        if (!ok) {
+            return;
+        }
+        config_->setJobCores(cores);
+        jobs_->setCoreBudget(cores);
+    });
+    connect(menu->addAction("取消全部任务"), &QAction::triggered, this, [this]() { jobs_->cancelAll(); });
+    connect(menu->addAction("关闭已结束的任务页"), &QAction::triggered, this, [this]() {
+        for (int i = ui->tabOutput->count() - 1; i > 0; --i) {
+            QWidget* page = ui->tabOutput->widget(i);
+            for (auto it = jobTabs_.constBegin(); it != jobTabs_.constEnd(); ++it) {
+                const Job* job = jobs_->job(it.key());
+                if (it->page == page && job && job->isDone()) {
+                    CloseJobTab(i);
+                    break;
+                }
+            }
+        }
+    });
+    ui->btnQueue->setMenu(menu);
+}
+
+void CmakeBuilder::QueueProjects(const QStringList& keys, bool run)
+{
+    QString cur = ui->cbProject->currentText().trimmed();
+    for (const QString& key : keys) {
+        // 当前项目按界面上的设置入队，其余项目使用保存的配置
+        OneConfig o;
+        if (key == cur) {
+            o = CurrentJobConfig();
+        } else if (!config_->GetData(key, o)) {
+            Print("错误：无法读取项目配置 " + key, true);
+            continue;
+        }
+        if (o.cmakePath.isEmpty() || o.sourceDir.isEmpty() || o.buildDir.isEmpty()) {
+            Print("错误：项目 " + key + " 缺少 CMake、源码或构建目录设置", true);
+            continue;
+        }
+        jobs_->addChain(o, run);
+    }
+}
+
+void CmakeBuilder::SelectQueueProjects()
+{
+    QVector<QString> keys;
+    if (!config_->GetAllKeys(keys) || keys.isEmpty()) {
+        QMessageBox::information(this, "提示", "没有已保存的项目配置");
+        return;
+    }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("加入队列");
+    QVBoxLayout* layout = new QVBoxLayout(&dialog);
+    QListWidget* list = new QListWidget(&dialog);
+    for (const QString& key : keys) {
+        QListWidgetItem* item = new QListWidgetItem(key, list);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Unchecked);
+    }
+    QCheckBox* runBox = new QCheckBox("构建完成后运行目标", &dialog);
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addWidget(list);
+    layout->addWidget(runBox);
+    layout->addWidget(buttons);
+
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+    QStringList selected;
+    for (int i = 0; i < list->count(); ++i) {
+        if (list->item(i)->checkState() == Qt::Checked) {
+            selected << list->item(i)->text();
+        }
+    }
+    QueueProjects(selected, runBox->isChecked());
+}
+
+void CmakeBuilder::onJobAdded(int id)
+{
+    const Job* job = jobs_->job(id);
+    if (!job) {
+        return;
+    }
+
+    JobTab tab;
+    tab.page = new QWidget;
+    QVBoxLayout* layout = new QVBoxLayout(tab.page);
+    layout->setContentsMargins(0, 0, 0, 0);
+    tab.view = new LogView(tab.page);
+    tab.bar = new QProgressBar(tab.page);
+    tab.bar->setVisible(job->kind == Job::Build);
+    layout->addWidget(tab.view);
+    layout->addWidget(tab.bar);
+    tab.sink = new LogSink(tab.view, tab.page);
+    // 各任务页使用与当前输出相同的日志内存上限
+    int limit = config_->getLogLimit();
+    tab.view->store()->setSpillDir(logDir_);
+    tab.view->store()->setMemoryLimit(static_cast<qint64>(limit > 0 ? limit : DEFAULT_LOG_LIMIT_MB) * 1024 * 1024);
+    jobTabs_.insert(id, tab);
+
+    ui->tabOutput->addTab(tab.page, QString());
+    onJobChanged(id);
+}
+
+void CmakeBuilder::onJobChanged(int id)
+{
+    const Job* job = jobs_->job(id);
+    auto it = jobTabs_.find(id);
+    if (!job || it == jobTabs_.end()) {
+        return;
+    }
+
+    JobTab& tab = it.value();
+    int index = ui->tabOutput->indexOf(tab.page);
+    QString name = job->config.key + " " + JobQueue::kindName(job->kind);
+    ui->tabOutput->setTabText(index, name + " [" + JobQueue::stateName(job->state) + "]");
+
+    if (job->state == Job::Running && !tab.started) {
+        tab.started = true;
+        ui->tabOutput->setTabToolTip(index, job->command);
+        // 说明可能有多行，例如配置前的警告
+        for (const QString& line : job->note.split('\n')) {
+            tab.sink->append(line);
+        }
+        tab.sink->append("命令: " + job->command);
+        tab.sink->append("配置: " + job->mode);
+        if (job->kind == Job::Build) {
+            tab.sink->append(QString("并行: %1").arg(job->cores));
+        }
+        tab.sink->append(SL);
+    } else if (job->isDone()) {
+        // 读取剩余的输出
+        onJobOutput(id);
+        if (!tab.started) {
+            for (const QString& line : job->note.split('\n')) {
+                tab.sink->append(line);
+            }
+        }
+        tab.sink->append(SL);
+        bool failed = job->state == Job::Failed;
+        QString text = JobQueue::stateName(job->state);
+        if (!job->error.isEmpty()) {
+            text += "：" + job->error;
+        }
+        if (job->elapsedMs >= 0) {
+            text += QString("（耗时 %1 s）").arg(job->elapsedMs / 1000.0, 0, 'f', 1);
+        }
+        tab.sink->append(text, failed);
+        if (job->state == Job::Succeeded && job->kind == Job::Build) {
+            tab.bar->setValue(tab.bar->maximum());
+        }
+    }
+    UpdateQueueButton();
+}
+
+void CmakeBuilder::onJobOutput(int id)
+{
+    ProcessRunner* runner = jobs_->runner(id);
+    auto it = jobTabs_.constFind(id);
+    if (!runner || it == jobTabs_.constEnd()) {
+        return;
+    }
+
+    QVector<OutputLine> lines;
+    runner->takeLines(lines);
+    for (const OutputLine& line : lines) {
+        if (!line.hidden) {
+            it->sink->append(line.text, line.isError, line.time, line.styles);
+        }
+    }
+}
+
+void CmakeBuilder::onJobProgress(int id)
+{
+    ProcessRunner* runner = jobs_->runner(id);
+    auto it = jobTabs_.constFind(id);
+    if (!runner || it == jobTabs_.constEnd()) {
+        return;
+    }
+
+    NinjaProgress p = runner->takeProgress();
+    if (p.total <= 0) {
+        return;
+    }
+    it->bar->setMaximum(p.total);
+    it->bar->setValue(p.finished);
+}
+
+void CmakeBuilder::CloseJobTab(int index)
+{
+    QWidget* page = ui->tabOutput->widget(index);
+    for (auto it = jobTabs_.begin(); it != jobTabs_.end(); ++it) {
+        if (it->page != page) {
+            continue;
+        }
+        int id = it.key();
+        const Job* job = jobs_->job(id);
+        if (job && !job->isDone()) {
+            int ret = QMessageBox::question(this, "确认操作", "任务尚未结束，确定要取消吗？");
+            if (ret == QMessageBox::Yes) {
+                jobs_->cancel(id);
+            }
+            return;
+        }
+        jobs_->remove(id);
+        jobTabs_.erase(it);
+        ui->tabOutput->removeTab(index);
+        page->deleteLater();
+        return;
+    }
+}
+
+void CmakeBuilder::UpdateQueueButton()
+{
+    int active = 0;
+    for (auto it = jobTabs_.constBegin(); it != jobTabs_.constEnd(); ++it) {
+        const Job* job = jobs_->job(it.key());
+        if (job && !job->isDone()) {
+            ++active;
+        }
+    }
+    ui->btnQueue->setText(active > 0 ? QString("队列 (%1)").arg(active) : QString("队列"));
 }
@@ -7,7 +7,21 @@
 #include <QProcess>
 #include <QtConcurrent>
 
+#include "buildhistory.h"
+#include "buildtrace.h"
 #include "config.h"
+#include "configfingerprint.h"
+#include "configprofile.h"
+#include "diagnostics.h"
+#include "logindex.h"
+#include "timetrace.h"
+
+class LogSink;
+class LogView;
+class QProgressBar;
+class QTreeWidgetItem;
+class ProcessRunner;
+class JobQueue;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -28,12 +42,20 @@ protected:
 
 private:
     void InitData();
+    void InitLogLimit(const QString& configDir);
+    void InitPty();
     void LoadConfig();
     bool SimpleLoad();
     OneConfig ReadUi();
+    OneConfig CurrentJobConfig();
     void SetUi(const OneConfig& o);
     void SaveCur(bool isNotice);
     void terminalProcess();
+    QString CurrentBuildTree();
+    void LoadTargets();
+    bool SkipConfigure(const QString& buildTree, const QString& cmake, const QStringList& arguments,
+                       const QProcessEnvironment& env);
+    QStringList ProfileArguments(const QString& buildTree);
     void InitTab();
 
 public:
@@ -45,8 +67,6 @@ public:
     void onBuildNinjaChanged(const QString& path);
 
     QProcessEnvironment getVCEnvironment(const QString& vcvarsPath);
-    QProcessEnvironment parseEnvironmentOutput(const QString& output);
-    QString expandEnvVar(const QProcessEnvironment& env, const QString& str);
 
     void onTableContextMenu(const QPoint& pos);
     void setTypeComboBox(int row, const QStringList& options);
@@ -54,7 +74,6 @@ public:
     void addTableRow();
     void deleteTableRow();
     void clearTable();
-    QVector<QString> getAddArgsFromTable(const QProcessEnvironment& env);
 
     void DisableBtn();
     void EnableBtn();
@@ -69,25 +88,96 @@ public Q_SLOTS:
 
 private slots:
     void onProcessReadyRead();
+    void onProcessStarted();
     void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void onProcessError(QProcess::ProcessError error);
+    void onBuildProgress();
+    void onJobAdded(int id);
+    void onJobChanged(int id);
+    void onJobOutput(int id);
+    void onJobProgress(int id);
 
 private:
-    QProcess* process_;
+    ProcessRunner* process_;
     QVector<QString> getTarget();
+    void ResetProgress();
+    void InitDiagPanel();
+    void AddDiagnostic(const Diagnostic& diag);
+    void AddDuplicateDiagnostic(const Diagnostic& diag);
+    void UpdateDiagHeader();
+    void InitReportPanel();
+    void AnalyzeBuild(const HistoryRecord& record);
+    void ShowBuildReport(const BuildReport& report);
+    void AnalyzeTimeTrace();
+    void AnalyzeConfigProfile();
+    void ShowConfigProfile(const ConfigProfileReport& report, const ConfigProfileReport& previous);
+    void ShowTimeTrace(const TimeTraceReport& report);
+    void ExportTrace();
+    void PrepareHistory(const QString& kind, const QString& mode, const QString& target);
+    void RecordHistory(HistoryRecord record, const BuildReport& report);
+    void Mark(const QString& name, const QString& category, qint64 startMs, qint64 endMs = -1,
+              const QString& detail = QString());
+    void ClearOutput();
+    void InitSearch();
+    void RunSearch();
+    void UpdateSearch();
+    void SearchStep(int step);
+    void InitQueue();
+    void QueueProjects(const QStringList& keys, bool run);
+    void SelectQueueProjects();
+    void CloseJobTab(int index);
+    void UpdateQueueButton();
 
 private:
     BuilderConfig* config_{};
-    QString curType_;
+    LogSink* logSink_{};
     QString curTarget_;
     QString curVcEnv_;
     QString curEnvBatFile_;
     QString buildFile_;
+    QString logDir_;
     QString currentTaskName_;
     QProcessEnvironment curEnvValue_;
+    // 本次配置的指纹，成功后保存到构建树中
+    ConfigFingerprint::Fingerprint pendingFingerprint_;
+    QString configTree_;
+    bool forceConfig_{};
+    // 本次配置的性能分析输出，未开启时为空
+    QString profileFile_;
+    // 构建开始前 .ninja_log 的大小，用于取出本次构建执行的边
+    QString buildTree_;
+    qint64 ninjaLogOffset_{};
+    // 最近一次配置和构建的时间线：界面事件作为标记，构建分析结果用于导出跟踪
+    QVector<BuildTrace::Marker> traceMarkers_;
+    int configMarkers_{};   // 属于配置阶段的标记数，新的构建保留它们
+    qint64 taskStartMs_{};
+    qint64 buildStartMs_{};
+    BuildReport lastReport_;
+    QMap<QString, QString> traceInfo_;
+    // 每次配置和构建的耗时记录，当前任务的记录在结束时写入
+    BuildHistory* history_{};
+    HistoryRecord pendingHistory_;
     bool configRet_;
     QVector<QString> typeOptions_;
     QVector<QString> modes_;
+    QList<QPair<double, int>> progressSamples_;
+    DiagnosticIndex diagIndex_;
+    QHash<int, QTreeWidgetItem*> diagItems_;
+    LogIndex::Query searchQuery_;
+    QVector<int> searchHits_;
+    int searchedTo_{};
+    int searchPos_{-1};
+    bool searchValid_{true};
+    // 队列中每个任务一个输出页
+    struct JobTab {
+        QWidget* page{};
+        LogView* view{};
+        LogSink* sink{};
+        QProgressBar* bar{};
+        bool started{};
+    };
+    JobQueue* jobs_{};
+    QHash<int, JobTab> jobTabs_;
 
 private:
     Ui::CmakeBuilder* ui;
@@ -1,6 +1,7 @@
 #include "config.h"
 
 #include <QDateTime>
+#include <QDir>
 #include <QFile>
 #include <fstream>
 #include <nlohmann/json.hpp>
@@ -16,6 +17,12 @@ public:
     json configToJson(const OneConfig& config);
     bool setSize(int w, int h);
     std::pair<int, int> getSize();
+    bool setLogLimit(int mb);
+    int getLogLimit();
+    bool setUsePty(bool use);
+    bool getUsePty();
+    bool setJobCores(int cores);
+    int getJobCores();
     bool SaveData(const OneConfig& config);
     bool GetData(const QString& key, OneConfig& config);
     bool GetCurUse(QString& key);
@@ -126,6 +133,67 @@ std::pair<int, int> ConfigPrivate::getSize()
     }
 }
 
+bool ConfigPrivate::setLogLimit(int mb)
+{
+    if (mb <= 0) {
+        SetError("错误：日志内存上限必须大于0");
+        return false;
+    }
+
+    if (configSize_.isEmpty()) {
+        SetError("错误：配置文件路径未设置");
+        return false;
+    }
+
+    try {
+        json j;
+        if (QFile::exists(configSize_)) {
+            if (!loadJsonFromFile(j, configSize_)) {
+                SetError("警告：无法读取现有配置文件，将创建新文件");
+            }
+        }
+
+        if (!j.contains("log") || !j["log"].is_object()) {
+            j["log"] = json::object();
+        }
+        j["log"]["memory_limit_mb"] = mb;
+
+        if (saveJsonToFile(j, configSize_)) {
+            return true;
+        }
+        SetError("错误：保存日志内存上限失败");
+        return false;
+
+    } catch (const std::exception& e) {
+        SetError(QString("错误：设置日志内存上限时发生异常: %1").arg(e.what()));
+        return false;
+    }
+}
+
+int ConfigPrivate::getLogLimit()
+{
+    if (configSize_.isEmpty() || !QFile::exists(configSize_)) {
+        return 0;
+    }
+
+    try {
+        json j;
+        if (!loadJsonFromFile(j, configSize_)) {
+            SetError("错误：无法读取配置文件");
+            return 0;
+        }
+        if (!j.contains("log") || !j["log"].is_object()) {
+            return 0;
+        }
+        int mb = j["log"].value("memory_limit_mb", 0);
+        return mb > 0 ? mb : 0;
+
+    } catch (const std::exception& e) {
+        SetError(QString("错误：读取日志内存上限时发生异常: %1").arg(e.what()));
+        return 0;
+    }
+}
+
 // 私有辅助函数
 bool ConfigPrivate::loadJsonFromFile(json& j, const QString& filename)
 {
@@ -177,6 +245,7 @@ OneConfig ConfigPrivate::jsonToConfig(const json& j)
     config.curType = QString::fromStdString(j.value("curType", ""));
     config.vcEnv = QString::fromStdString(j.value("vcEnv", ""));
     config.arg = QString::fromStdString(j.value("arg", ""));
+    config.timeTrace = j.value("timeTrace", false);
 
     if (j.contains("additionArgs") && j["additionArgs"].is_array()) {
         for (const auto& argJson : j["additionArgs"]) {
@@ -204,6 +273,7 @@ json ConfigPrivate::configToJson(const OneConfig& config)
     j["curType"] = config.curType.toStdString();
     j["vcEnv"] = config.vcEnv.toStdString();
     j["arg"] = config.arg.toStdString();
+    j["timeTrace"] = config.timeTrace;
 
     json argsArray = json::array();
     for (const AddArgItem& item : config.additonArgs) {
@@ -419,6 +489,11 @@ BuilderConfig::~BuilderConfig()
     delete p_;
 }
 
+QString BuilderConfig::defaultDir()
+{
+    return QDir::homePath() + "/.config/cmakeBuilder";
+}
+
 void BuilderConfig::setConfigDir(const QString& d)
 {
     p_->configFile_ = d;
@@ -448,11 +523,163 @@ bool BuilderConfig::setSize(int w, int h)
     return r;
 }
 
+bool ConfigPrivate::setUsePty(bool use)
+{
+    if (configSize_.isEmpty()) {
+        SetError("错误：配置文件路径未设置");
+        return false;
+    }
+
+    try {
+        json j;
+        if (QFile::exists(configSize_)) {
+            if (!loadJsonFromFile(j, configSize_)) {
+                SetError("警告：无法读取现有配置文件，将创建新文件");
+            }
+        }
+
+        if (!j.contains("log") || !j["log"].is_object()) {
+            j["log"] = json::object();
+        }
+        j["log"]["pty"] = use;
+
+        if (saveJsonToFile(j, configSize_)) {
+            return true;
+        }
+        SetError("错误：保存终端模式设置失败");
+        return false;
+
+    } catch (const std::exception& e) {
+        SetError(QString("错误：设置终端模式时发生异常: %1").arg(e.what()));
+        return false;
+    }
+}
+
+bool ConfigPrivate::getUsePty()
+{
+    if (configSize_.isEmpty() || !QFile::exists(configSize_)) {
+        return false;
+    }
+
+    try {
+        json j;
+        if (!loadJsonFromFile(j, configSize_)) {
+            SetError("错误：无法读取配置文件");
+            return false;
+        }
+        if (!j.contains("log") || !j["log"].is_object()) {
+            return false;
+        }
+        return j["log"].value("pty", false);
+
+    } catch (const std::exception& e) {
+        SetError(QString("错误：读取终端模式设置时发生异常: %1").arg(e.what()));
+        return false;
+    }
+}
+
+bool ConfigPrivate::setJobCores(int cores)
+{
+    if (configSize_.isEmpty()) {
+        SetError("错误：配置文件路径未设置");
+        return false;
+    }
+
+    try {
+        json j;
+        if (QFile::exists(configSize_)) {
+            if (!loadJsonFromFile(j, configSize_)) {
+                SetError("警告：无法读取现有配置文件，将创建新文件");
+            }
+        }
+
+        if (!j.contains("queue") || !j["queue"].is_object()) {
+            j["queue"] = json::object();
+        }
+        j["queue"]["cores"] = cores;
+
+        if (saveJsonToFile(j, configSize_)) {
+            return true;
+        }
+        SetError("错误：保存并行核心数失败");
+        return false;
+
+    } catch (const std::exception& e) {
+        SetError(QString("错误：设置并行核心数时发生异常: %1").arg(e.what()));
+        return false;
+    }
+}
+
+int ConfigPrivate::getJobCores()
+{
+    if (configSize_.isEmpty() || !QFile::exists(configSize_)) {
+        return 0;
+    }
+
+    try {
+        json j;
+        if (!loadJsonFromFile(j, configSize_)) {
+            SetError("错误：无法读取配置文件");
+            return 0;
+        }
+        if (!j.contains("queue") || !j["queue"].is_object()) {
+            return 0;
+        }
+        return j["queue"].value("cores", 0);
+
+    } catch (const std::exception& e) {
+        SetError(QString("错误：读取并行核心数时发生异常: %1").arg(e.what()));
+        return 0;
+    }
+}
+
 std::pair<int, int> BuilderConfig::getSize()
 {
     return p_->getSize();
 }
 
+bool BuilderConfig::setLogLimit(int mb)
+{
+    auto r = p_->setLogLimit(mb);
+    if (!r) {
+        emit sigMsg(p_->errMsg_);
+    }
+    return r;
+}
+
+int BuilderConfig::getLogLimit()
+{
+    return p_->getLogLimit();
+}
+
+bool BuilderConfig::setUsePty(bool use)
+{
+    auto r = p_->setUsePty(use);
+    if (!r) {
+        emit sigMsg(p_->errMsg_);
+    }
+    return r;
+}
+
+bool BuilderConfig::getUsePty()
+{
+    return p_->getUsePty();
+}
+
+bool BuilderConfig::setJobCores(int cores)
+{
+    auto r = p_->setJobCores(cores);
+    if (!r) {
+        emit sigMsg(p_->errMsg_);
+    }
+    return r;
+}
+
+int BuilderConfig::getJobCores()
+{
+    return p_->getJobCores();
+}
+
 bool BuilderConfig::SaveData(const OneConfig& config)
 {
     auto r = p_->SaveData(config);
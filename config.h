@@ -22,6 +22,8 @@ struct OneConfig {
     QString vcEnv;
     QString arg;
     QVector<AddArgItem> additonArgs;
+    // 为 Clang 注入 -ftime-trace，构建后汇总各编译单元的耗时
+    bool timeTrace{};
 };
 
 class ConfigPrivate;
@@ -34,6 +36,8 @@ public:
     ~BuilderConfig();
 
 public:
+    // 界面和命令行模式共用的配置目录
+    static QString defaultDir();
     void setConfigDir(const QString& d);
     void setConfigSizeDir(const QString& d);
     void setConfigUseDir(const QString& d);
@@ -42,6 +46,13 @@ public:
     bool GetAllKeys(QVector<QString>& keys);
     bool setSize(int w, int h);
     std::pair<int, int> getSize();
+    bool setLogLimit(int mb);
+    int getLogLimit();
+    bool setUsePty(bool use);
+    bool getUsePty();
+    // 任务队列并行使用的 CPU 核心数，0 表示未设置
+    bool setJobCores(int cores);
+    int getJobCores();
     bool SaveData(const OneConfig& config);
     bool GetData(const QString& key, OneConfig& config);
     bool GetCurUse(QString& key);
@@ -0,0 +1,249 @@
+#include "configfingerprint.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+namespace {
+
+constexpr auto INPUT_PREFIX = "input:";
+
+QString fingerprintFile(const QString& buildTree)
+{
+    return buildTree + "/CMakeFiles/cmakebuilder.fingerprint";
+}
+
+QString hashOf(const QStringList& items)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString& item : items) {
+        hash.addData(item.toUtf8());
+        hash.addData("\n", 1);
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+// CMake 配置及其探测的编译器会读取的环境变量。会话相关的变量（SESSIONNAME、DBUS_SESSION_BUS_ADDRESS、
+// XDG_*、终端和 IDE 设置的变量等）每次启动都可能不同，计入指纹会让配置几乎无法跳过。
+// Windows 的环境变量名不区分大小写，统一按大写比较
+bool affectsConfigure(const QString& name)
+{
+    static const QStringList exact = {
+        "PATH", "CC", "CXX", "FC", "RC", "ASM", "CUDACXX", "CUDAHOSTCXX", "CL", "_CL_", "LINK", "_LINK_",
+        "INCLUDE", "LIB", "LIBPATH", "CPATH", "C_INCLUDE_PATH", "CPLUS_INCLUDE_PATH", "LIBRARY_PATH",
+        "SDKROOT", "MACOSX_DEPLOYMENT_TARGET", "PLATFORM", "DEVENVDIR", "EXTENSIONSDKDIR",
+    };
+    // vcvars 设置的变量：VSINSTALLDIR、VCToolsVersion、VSCMD_ARG_TGT_ARCH、WindowsSdkDir、UCRTVersion 等
+    static const QStringList prefixes = {
+        "CMAKE_", "PKG_CONFIG_", "VS", "VC", "__VSCMD", "WINDOWSSDK", "WINDOWSLIBPATH", "UCRT", "UNIVERSALCRT",
+        "FRAMEWORK", "NETFXSDK",
+    };
+    QString upper = name.toUpper();
+    if (exact.contains(upper) || upper.endsWith("FLAGS") || upper.endsWith("_ROOT") || upper.endsWith("_DIR")) {
+        return true;
+    }
+    for (const QString& prefix : prefixes) {
+        if (upper.startsWith(prefix)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QString modifiedTime(const QString& path)
+{
+    QFileInfo info(path);
+    if (!info.exists()) {
+        return QString();
+    }
+    return QString::number(info.lastModified().toMSecsSinceEpoch());
+}
+
+bool load(const QString& buildTree, ConfigFingerprint::Fingerprint& saved)
+{
+    QFile file(fingerprintFile(buildTree));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    while (!file.atEnd()) {
+        QString line = QString::fromUtf8(file.readLine()).trimmed();
+        int tab = line.indexOf('\t');
+        if (tab > 0) {
+            saved.insert(line.left(tab), line.mid(tab + 1));
+        }
+    }
+    return !saved.isEmpty();
+}
+
+// 读取 "build build.ninja: RERUN_CMAKE | 输入..." 语句，处理行尾 $ 续行和 $ 转义
+QStringList parseRerunInputs(const QString& ninjaFile)
+{
+    QFile file(ninjaFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QStringList();
+    }
+
+    QByteArray stmt;
+    bool inStmt = false;
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        while (line.endsWith('\n') || line.endsWith('\r')) {
+            line.chop(1);
+        }
+        if (!inStmt) {
+            if (!line.startsWith("build ") || !line.contains(": RERUN_CMAKE")) {
+                continue;
+            }
+            inStmt = true;
+        }
+        int dollars = 0;
+        while (dollars < line.size() && line.at(line.size() - 1 - dollars) == '$') {
+            ++dollars;
+        }
+        if (dollars % 2 == 1) {
+            stmt += line.left(line.size() - 1);
+            continue;
+        }
+        stmt += line;
+        break;
+    }
+    if (stmt.isEmpty()) {
+        return QStringList();
+    }
+
+    QStringList inputs;
+    QByteArray rest = stmt.mid(stmt.indexOf(": RERUN_CMAKE") + 13);
+    QByteArray token;
+    QDir base = QFileInfo(ninjaFile).absoluteDir();
+    auto flush = [&]() -> bool {
+        if (token == "||") {
+            return false;
+        }
+        if (!token.isEmpty() && token != "|") {
+            inputs << QDir::cleanPath(base.absoluteFilePath(QString::fromUtf8(token)));
+        }
+        token.clear();
+        return true;
+    };
+    for (int i = 0; i < rest.size(); ++i) {
+        char c = rest.at(i);
+        if (c == '$' && i + 1 < rest.size()) {
+            token += rest.at(++i);
+        } else if (c == ' ') {
+            if (!flush()) {
+                return inputs;
+            }
+        } else {
+            token += c;
+        }
+    }
+    flush();
+    return inputs;
+}
+
+}   // namespace
+
+namespace ConfigFingerprint {
+
+Fingerprint compute(const QString& cmake, const QStringList& arguments, const QProcessEnvironment& env)
+{
+    QStringList vars;
+    for (const QString& name : env.keys()) {
+        if (affectsConfigure(name)) {
+            vars << name.toUpper() + "=" + env.value(name);
+        }
+    }
+    vars.sort();
+
+    Fingerprint fp;
+    fp.insert("cmake", cmake + "|" + modifiedTime(cmake));
+    fp.insert("args", hashOf(arguments));
+    fp.insert("env", hashOf(vars));
+    return fp;
+}
+
+QStringList cmakeInputs(const QString& buildTree)
+{
+    // 多配置生成器把重新配置规则放在 CMakeFiles/common.ninja 中
+    QStringList inputs = parseRerunInputs(buildTree + "/build.ninja");
+    if (inputs.isEmpty()) {
+        inputs = parseRerunInputs(buildTree + "/CMakeFiles/common.ninja");
+    }
+    return inputs;
+}
+
+bool upToDate(const QString& buildTree, const QString& ninjaFile, const Fingerprint& current, QString& reason)
+{
+    if (!QFile::exists(buildTree + "/CMakeCache.txt") || !QFile::exists(ninjaFile)) {
+        reason = "构建树尚未生成";
+        return false;
+    }
+
+    Fingerprint saved;
+    if (!load(buildTree, saved)) {
+        reason = "没有上次成功配置的记录";
+        return false;
+    }
+
+    static const char* parts[][2] = {
+        {"cmake", "CMake 程序已变化"},
+        {"args", "CMake 参数已变化"},
+        {"env", "环境变量已变化"},
+    };
+    for (const auto& part : parts) {
+        if (saved.value(part[0]) != current.value(part[0])) {
+            reason = part[1];
+            return false;
+        }
+    }
+
+    int inputs = 0;
+    for (auto it = saved.constBegin(); it != saved.constEnd(); ++it) {
+        if (!it.key().startsWith(INPUT_PREFIX)) {
+            continue;
+        }
+        ++inputs;
+        QString path = it.key().mid(static_cast<int>(qstrlen(INPUT_PREFIX)));
+        QString mtime = modifiedTime(path);
+        if (mtime != it.value()) {
+            reason = (mtime.isEmpty() ? "输入文件已删除: " : "输入文件已修改: ") + path;
+            return false;
+        }
+    }
+    if (inputs == 0) {
+        reason = "上次配置没有记录输入文件";
+        return false;
+    }
+
+    reason = QString("参数、环境和 %1 个 CMake 输入文件均未变化").arg(inputs);
+    return true;
+}
+
+bool save(const QString& buildTree, const Fingerprint& current)
+{
+    Fingerprint fp = current;
+    QStringList inputs = cmakeInputs(buildTree);
+    // 手动修改缓存（ccmake 等）同样需要重新配置
+    inputs << buildTree + "/CMakeCache.txt";
+    for (const QString& input : inputs) {
+        fp.insert(INPUT_PREFIX + input, modifiedTime(input));
+    }
+
+    QFile file(fingerprintFile(buildTree));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    for (auto it = fp.constBegin(); it != fp.constEnd(); ++it) {
+        file.write((it.key() + "\t" + it.value() + "\n").toUtf8());
+    }
+    return true;
+}
+
+void invalidate(const QString& buildTree)
+{
+    QFile::remove(fingerprintFile(buildTree));
+}
+
+}   // namespace ConfigFingerprint
@@ -0,0 +1,27 @@
+#ifndef CONFIGFINGERPRINT_H
+#define CONFIGFINGERPRINT_H
+
+#include <QMap>
+#include <QProcessEnvironment>
+#include <QStringList>
+
+// 配置指纹：cmake 程序、完整参数、CMake 会读取的环境变量，以及 build.ninja 重新配置规则中
+// 列出的 CMake 输入文件的修改时间。与上次成功配置时保存的指纹一致时可以跳过配置。
+// 指纹保存在构建树中，清空构建树即失效。
+namespace ConfigFingerprint {
+
+using Fingerprint = QMap<QString, QString>;
+
+// 不含输入文件部分的指纹，输入文件在配置成功后由 save 从 build.ninja 中读取
+Fingerprint compute(const QString& cmake, const QStringList& arguments, const QProcessEnvironment& env);
+// 与保存的指纹比较，reason 说明跳过或需要执行配置的原因
+bool upToDate(const QString& buildTree, const QString& ninjaFile, const Fingerprint& current, QString& reason);
+bool save(const QString& buildTree, const Fingerprint& current);
+// 配置开始前删除旧指纹，配置失败或被取消时下次一定重新执行
+void invalidate(const QString& buildTree);
+// build.ninja 中 RERUN_CMAKE 规则的输入文件
+QStringList cmakeInputs(const QString& buildTree);
+
+}   // namespace ConfigFingerprint
+
+#endif
@@ -0,0 +1,278 @@
+#include "configprofile.h"
+
+#include <QFile>
+#include <QHash>
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+struct Event {
+    std::string name;
+    std::string ph;
+    std::string functionArgs;
+    std::string location;
+    qint64 ts{};
+    qint64 dur{};
+};
+
+// 合并同一调用的依据：execute_process 取整条命令，其余取第一个参数（包名、模块、结果变量）
+QString callKey(const QString& command, const QString& args)
+{
+    QString simplified = args.simplified();
+    if (command == "execute_process") {
+        return simplified.left(120);
+    }
+    return simplified.section(' ', 0, 0);
+}
+
+// 边解析边汇总，不保留事件本身
+struct Collector {
+    ConfigProfileReport& report;
+    QStringList watched;
+    QHash<QString, QHash<QString, ConfigProfileItem>> calls;
+    qint64 first{-1};
+    qint64 last{};
+
+    explicit Collector(ConfigProfileReport& r) : report(r), watched(ConfigProfile::watchedCommands())
+    {
+    }
+
+    void add(const Event& e)
+    {
+        ++report.events;
+        first = first < 0 ? e.ts : qMin(first, e.ts);
+        last = qMax(last, e.ts + e.dur);
+
+        // 命令名不区分大小写，CMake 按调用时的写法记录
+        QString command = QString::fromStdString(e.name).toLower();
+        ConfigProfileItem& total = report.commands[command];
+        total.command = command;
+        total.totalUs += e.dur;
+        total.maxUs = qMax(total.maxUs, e.dur);
+        ++total.count;
+
+        if (!watched.contains(command)) {
+            return;
+        }
+        QString key = callKey(command, QString::fromStdString(e.functionArgs));
+        ConfigProfileItem& item = calls[command][key];
+        item.command = command;
+        item.call = command + "(" + key + ")";
+        item.totalUs += e.dur;
+        ++item.count;
+        if (e.dur >= item.maxUs) {
+            item.maxUs = e.dur;
+            item.location = QString::fromStdString(e.location);
+        }
+    }
+};
+
+// CMake 输出的是事件数组，也兼容 {"traceEvents": [...]} 形式。
+// eventsDepth_ 为事件数组所在层级，事件对象在其下一层，args 再下一层
+class ProfileHandler : public nlohmann::json_sax<json>
+{
+public:
+    explicit ProfileHandler(Collector& collector) : collector_(collector)
+    {
+    }
+
+    bool null() override
+    {
+        return true;
+    }
+
+    bool boolean(bool) override
+    {
+        return true;
+    }
+
+    bool number_integer(number_integer_t val) override
+    {
+        return number(static_cast<qint64>(val));
+    }
+
+    bool number_unsigned(number_unsigned_t val) override
+    {
+        return number(static_cast<qint64>(val));
+    }
+
+    bool number_float(number_float_t val, const string_t&) override
+    {
+        return number(static_cast<qint64>(val));
+    }
+
+    bool string(string_t& val) override
+    {
+        if (inEvent()) {
+            if (key_ == "name") {
+                event_.name = val;
+            } else if (key_ == "ph") {
+                event_.ph = val;
+            }
+        } else if (inArgs_ && depth_ == eventsDepth_ + 2) {
+            if (key_ == "functionArgs") {
+                event_.functionArgs = val;
+            } else if (key_ == "location") {
+                event_.location = val;
+            }
+        }
+        return true;
+    }
+
+    bool binary(binary_t&) override
+    {
+        return true;
+    }
+
+    bool start_object(std::size_t) override
+    {
+        ++depth_;
+        if (eventsDepth_ > 0 && depth_ == eventsDepth_ + 1) {
+            event_ = Event();
+        } else if (eventsDepth_ > 0 && depth_ == eventsDepth_ + 2 && key_ == "args") {
+            inArgs_ = true;
+        }
+        return true;
+    }
+
+    bool key(string_t& val) override
+    {
+        key_ = val;
+        return true;
+    }
+
+    bool end_object() override
+    {
+        if (eventsDepth_ > 0 && depth_ == eventsDepth_ + 2) {
+            inArgs_ = false;
+        } else if (inEvent() && event_.ph == "X") {
+            collector_.add(event_);
+        }
+        --depth_;
+        return true;
+    }
+
+    bool start_array(std::size_t) override
+    {
+        ++depth_;
+        if (eventsDepth_ == 0 && (depth_ == 1 || (depth_ == 2 && key_ == "traceEvents"))) {
+            eventsDepth_ = depth_;
+        }
+        return true;
+    }
+
+    bool end_array() override
+    {
+        if (depth_ == eventsDepth_) {
+            eventsDepth_ = -1;
+        }
+        --depth_;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override
+    {
+        return false;
+    }
+
+private:
+    bool inEvent() const
+    {
+        return eventsDepth_ > 0 && depth_ == eventsDepth_ + 1;
+    }
+
+    bool number(qint64 val)
+    {
+        if (inEvent()) {
+            if (key_ == "ts") {
+                event_.ts = val;
+            } else if (key_ == "dur") {
+                event_.dur = val;
+            }
+        }
+        return true;
+    }
+
+private:
+    Collector& collector_;
+    Event event_;
+    int depth_{};
+    int eventsDepth_{};
+    bool inArgs_{};
+    std::string key_;
+};
+
+}   // namespace
+
+namespace ConfigProfile {
+
+QStringList watchedCommands()
+{
+    return {"find_package", "try_compile", "execute_process", "include"};
+}
+
+QString outputFile(const QString& buildTree)
+{
+    return buildTree + "/CMakeFiles/cmakebuilder-profile.json";
+}
+
+QString previousFile(const QString& buildTree)
+{
+    return buildTree + "/CMakeFiles/cmakebuilder-profile.prev.json";
+}
+
+QStringList arguments(const QString& outputFile)
+{
+    return {"--profiling-format=google-trace", "--profiling-output=" + outputFile};
+}
+
+ConfigProfileReport analyze(const QString& file, int top)
+{
+    ConfigProfileReport report;
+#ifdef Q_OS_WIN
+    std::ifstream in(reinterpret_cast<const wchar_t*>(file.utf16()), std::ios::binary);
+#else
+    std::ifstream in(QFile::encodeName(file).constData(), std::ios::binary);
+#endif
+    if (!in.is_open()) {
+        report.error = "未找到配置性能分析文件 " + file;
+        return report;
+    }
+
+    Collector collector(report);
+    ProfileHandler handler(collector);
+    bool ok = false;
+    try {
+        ok = json::sax_parse(in, &handler);
+    } catch (const std::exception& e) {
+        report.error = QString("解析配置性能分析文件失败: %1").arg(e.what());
+        return report;
+    }
+    if (!ok) {
+        report.error = "解析配置性能分析文件失败: " + file;
+        return report;
+    }
+    report.valid = true;
+    report.totalUs = collector.first >= 0 ? collector.last - collector.first : 0;
+
+    for (const QString& command : collector.watched) {
+        QVector<ConfigProfileItem> items;
+        const QHash<QString, ConfigProfileItem> byCall = collector.calls.value(command);
+        for (auto it = byCall.constBegin(); it != byCall.constEnd(); ++it) {
+            items.append(it.value());
+        }
+        std::sort(items.begin(), items.end(),
+                  [](const ConfigProfileItem& a, const ConfigProfileItem& b) { return a.totalUs > b.totalUs; });
+        if (items.size() > top) {
+            items.resize(top);
+        }
+        report.slowest.insert(command, items);
+    }
+    return report;
+}
+
+}   // namespace ConfigProfile
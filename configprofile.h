@@ -0,0 +1,42 @@
+#ifndef CONFIGPROFILE_H
+#define CONFIGPROFILE_H
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 同一命令按主要参数合并的调用，耗时包含其内部的嵌套调用
+struct ConfigProfileItem {
+    QString command;
+    QString call;
+    QString location;   // 最慢一次调用的位置
+    qint64 totalUs{};
+    qint64 maxUs{};
+    int count{};
+};
+
+struct ConfigProfileReport {
+    bool valid{};
+    QString error;
+    qint64 totalUs{};
+    int events{};
+    QMap<QString, ConfigProfileItem> commands;              // 每种命令的总耗时和次数
+    QMap<QString, QVector<ConfigProfileItem>> slowest;      // 关注的命令 -> 最慢的调用
+};
+
+// CMake 3.18+ 的 --profiling-format=google-trace 配置性能分析。
+// 跟踪文件流式解析，统计 find_package、try_compile、execute_process 和 include 的耗时与次数。
+namespace ConfigProfile {
+
+// 关注的命令，按显示顺序
+QStringList watchedCommands();
+// 跟踪写在构建树的 CMakeFiles 下，上一次的结果保留为 previousFile，便于比较
+QString outputFile(const QString& buildTree);
+QString previousFile(const QString& buildTree);
+QStringList arguments(const QString& outputFile);
+ConfigProfileReport analyze(const QString& file, int top = 15);
+
+}   // namespace ConfigProfile
+
+#endif
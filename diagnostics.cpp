@@ -0,0 +1,356 @@
+#include "diagnostics.h"
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+static Diagnostic::Severity toSeverity(const QString& s)
+{
+    QString v = s.toLower();
+    if (v.contains("error")) {
+        return Diagnostic::Error;
+    }
+    if (v.contains("warning")) {
+        return Diagnostic::Warning;
+    }
+    if (v == "note" || v == "remark") {
+        return Diagnostic::Note;
+    }
+    return Diagnostic::None;
+}
+
+static QString jsonString(const json& j, const char* key)
+{
+    if (j.is_object() && j.contains(key) && j[key].is_string()) {
+        return QString::fromStdString(j[key].get<std::string>());
+    }
+    return QString();
+}
+
+static int jsonInt(const json& j, const char* key)
+{
+    if (j.is_object() && j.contains(key) && j[key].is_number_integer()) {
+        return j[key].get<int>();
+    }
+    return 0;
+}
+
+// 取对象成员中的对象，缺失或类型不符时为空对象；编译器之外的程序也可能输出形似 JSON 的行，
+// 不能对非对象调用 value()，否则抛出的 type_error 会在 I/O 线程中终止程序
+static const json& jsonObject(const json& j, const char* key)
+{
+    static const json empty = json::object();
+    if (j.is_object() && j.contains(key) && j[key].is_object()) {
+        return j[key];
+    }
+    return empty;
+}
+
+// 数组的第一个元素，不是非空数组时为空对象
+static const json& jsonFirst(const json& j, const char* key)
+{
+    static const json empty = json::object();
+    if (j.is_object() && j.contains(key) && j[key].is_array() && !j[key].empty()) {
+        return j[key][0];
+    }
+    return empty;
+}
+
+// GCC JSON 格式：[{"kind": ..., "message": ..., "locations": [{"caret": {...}}], "children": [...]}]
+static void readGccJson(const json& item, QVector<Diagnostic>& diags)
+{
+    if (!item.is_object()) {
+        return;
+    }
+    Diagnostic d;
+    d.severity = toSeverity(jsonString(item, "kind"));
+    d.message = jsonString(item, "message");
+    d.code = jsonString(item, "option");
+    const json& caret = jsonObject(jsonFirst(item, "locations"), "caret");
+    d.file = jsonString(caret, "file");
+    d.line = jsonInt(caret, "line");
+    d.column = jsonInt(caret, "column");
+    if (d.severity != Diagnostic::None) {
+        diags.append(d);
+    }
+    if (item.contains("children") && item["children"].is_array()) {
+        for (const auto& child : item["children"]) {
+            readGccJson(child, diags);
+        }
+    }
+}
+
+// SARIF 2.1.0：runs[].results[]，位置在 locations[].physicalLocation 中
+static void readSarif(const json& root, QVector<Diagnostic>& diags)
+{
+    if (!root.is_object() || !root.contains("runs") || !root["runs"].is_array()) {
+        return;
+    }
+    for (const auto& run : root["runs"]) {
+        if (!run.is_object() || !run.contains("results") || !run["results"].is_array()) {
+            continue;
+        }
+        for (const auto& result : run["results"]) {
+            if (!result.is_object()) {
+                continue;
+            }
+            Diagnostic d;
+            QString level = jsonString(result, "level");
+            d.severity = level.isEmpty() ? Diagnostic::Warning : toSeverity(level);
+            d.code = jsonString(result, "ruleId");
+            d.message = jsonString(jsonObject(result, "message"), "text");
+            const json& loc = jsonObject(jsonFirst(result, "locations"), "physicalLocation");
+            d.file = jsonString(jsonObject(loc, "artifactLocation"), "uri");
+            if (d.file.startsWith("file://")) {
+                d.file = d.file.mid(7);
+            }
+            const json& region = jsonObject(loc, "region");
+            d.line = jsonInt(region, "startLine");
+            d.column = jsonInt(region, "startColumn");
+            if (d.severity != Diagnostic::None) {
+                diags.append(d);
+            }
+        }
+    }
+}
+
+DiagnosticParser::DiagnosticParser()
+    : gccRe_(R"(^(.+?):(\d+):(?:(\d+):)?\s*(fatal error|error|warning|note):\s*(.*)$)"),
+      msvcRe_(R"(^\s*(.+?)\((\d+)(?:,(\d+))?\)\s*:\s*(fatal error|error|warning|note)\s*([A-Za-z]+\d+)?\s*:\s*(.*)$)"),
+      cmakeRe_(R"(^CMake (Error|Warning)(?: \(dev\))? at (.+?):(\d+))")
+{
+    gccRe_.optimize();
+    msvcRe_.optimize();
+    cmakeRe_.optimize();
+}
+
+bool DiagnosticParser::parseLine(const QString& line, Diagnostic& diag) const
+{
+    // 先做廉价的子串过滤，绝大多数普通输出行不会进入正则匹配
+    bool gccLike = line.contains(QLatin1String(": error")) || line.contains(QLatin1String(": warning")) ||
+                   line.contains(QLatin1String(": fatal error")) || line.contains(QLatin1String(": note"));
+    bool msvcLike = line.contains(QLatin1String("): ")) || line.contains(QLatin1String(") : "));
+    bool cmakeLike = line.startsWith(QLatin1String("CMake "));
+    if (!gccLike && !msvcLike && !cmakeLike) {
+        return false;
+    }
+
+    if (gccLike) {
+        QRegularExpressionMatch m = gccRe_.match(line);
+        if (m.hasMatch()) {
+            diag.file = m.captured(1).trimmed();
+            diag.line = m.captured(2).toInt();
+            diag.column = m.captured(3).toInt();
+            diag.severity = toSeverity(m.captured(4));
+            diag.code.clear();
+            diag.message = m.captured(5).trimmed();
+            // GCC/Clang 把警告选项放在末尾，如 [-Wunused-variable]
+            if (diag.message.endsWith(']')) {
+                int pos = diag.message.lastIndexOf(" [");
+                if (pos > 0) {
+                    diag.code = diag.message.mid(pos + 2, diag.message.size() - pos - 3);
+                }
+            }
+            return true;
+        }
+    }
+
+    if (msvcLike) {
+        QRegularExpressionMatch m = msvcRe_.match(line);
+        if (m.hasMatch()) {
+            diag.file = m.captured(1).trimmed();
+            diag.line = m.captured(2).toInt();
+            diag.column = m.captured(3).toInt();
+            diag.severity = toSeverity(m.captured(4));
+            diag.code = m.captured(5);
+            diag.message = m.captured(6).trimmed();
+            return true;
+        }
+    }
+
+    if (cmakeLike) {
+        QRegularExpressionMatch m = cmakeRe_.match(line);
+        if (m.hasMatch()) {
+            diag.severity = toSeverity(m.captured(1));
+            diag.file = m.captured(2).trimmed();
+            diag.line = m.captured(3).toInt();
+            diag.column = 0;
+            diag.code.clear();
+            diag.message = line.trimmed();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DiagnosticParser::parseStructured(const QString& line, QVector<Diagnostic>& diags) const
+{
+    QString trimmed = line.trimmed();
+    if (trimmed.isEmpty() || (trimmed[0] != '[' && trimmed[0] != '{')) {
+        return false;
+    }
+    if (!trimmed.contains(QLatin1String("\"kind\"")) && !trimmed.contains(QLatin1String("\"runs\""))) {
+        return false;
+    }
+
+    json j = json::parse(trimmed.toStdString(), nullptr, false);
+    if (j.is_discarded()) {
+        return false;
+    }
+
+    if (j.is_array()) {
+        for (const auto& item : j) {
+            readGccJson(item, diags);
+        }
+        return true;
+    }
+    if (j.is_object() && j.contains("runs")) {
+        readSarif(j, diags);
+        return true;
+    }
+    return false;
+}
+
+QString DiagnosticParser::severityName(Diagnostic::Severity severity)
+{
+    switch (severity) {
+    case Diagnostic::Error:
+        return "error";
+    case Diagnostic::Warning:
+        return "warning";
+    case Diagnostic::Note:
+        return "note";
+    default:
+        return QString();
+    }
+}
+
+QString DiagnosticParser::format(const Diagnostic& diag)
+{
+    QString pos = diag.file;
+    if (diag.line > 0) {
+        pos += ":" + QString::number(diag.line);
+        if (diag.column > 0) {
+            pos += ":" + QString::number(diag.column);
+        }
+    }
+    QString text = pos + ": " + severityName(diag.severity) + ": " + diag.message;
+    if (!diag.code.isEmpty()) {
+        text += " [" + diag.code + "]";
+    }
+    return text;
+}
+
+void DiagnosticIndex::clear()
+{
+    diags_.clear();
+    errors_ = 0;
+    warnings_ = 0;
+    notes_ = 0;
+    firstError_ = -1;
+    firstWarning_ = -1;
+    duplicates_ = 0;
+    groups_.clear();
+    groupUnits_.clear();
+}
+
+int DiagnosticIndex::add(const Diagnostic& diag)
+{
+    int index = diags_.size();
+    diags_.append(diag);
+    switch (diag.severity) {
+    case Diagnostic::Error:
+        ++errors_;
+        if (firstError_ < 0) {
+            firstError_ = index;
+        }
+        break;
+    case Diagnostic::Warning:
+        ++warnings_;
+        if (firstWarning_ < 0) {
+            firstWarning_ = index;
+        }
+        break;
+    case Diagnostic::Note:
+        ++notes_;
+        break;
+    default:
+        break;
+    }
+
+    if (diag.group >= 0) {
+        DiagnosticGroup& g = groups_[diag.group];
+        g.first = index;
+        g.count = 1;
+        if (!diag.unit.isEmpty()) {
+            g.units.append(diag.unit);
+            groupUnits_[diag.group].insert(diag.unit);
+        }
+    }
+    return index;
+}
+
+const DiagnosticGroup* DiagnosticIndex::addDuplicate(const Diagnostic& diag)
+{
+    auto it = groups_.find(diag.group);
+    if (it == groups_.end()) {
+        return nullptr;
+    }
+    ++duplicates_;
+    ++it->count;
+    if (!diag.unit.isEmpty()) {
+        QSet<QString>& units = groupUnits_[diag.group];
+        if (!units.contains(diag.unit)) {
+            units.insert(diag.unit);
+            it->units.append(diag.unit);
+        }
+    }
+    return &it.value();
+}
+
+const DiagnosticGroup* DiagnosticIndex::group(int id) const
+{
+    auto it = groups_.constFind(id);
+    return it == groups_.constEnd() ? nullptr : &it.value();
+}
+
+int DiagnosticIndex::duplicates() const
+{
+    return duplicates_;
+}
+
+int DiagnosticIndex::count() const
+{
+    return diags_.size();
+}
+
+int DiagnosticIndex::count(Diagnostic::Severity severity) const
+{
+    switch (severity) {
+    case Diagnostic::Error:
+        return errors_;
+    case Diagnostic::Warning:
+        return warnings_;
+    case Diagnostic::Note:
+        return notes_;
+    default:
+        return 0;
+    }
+}
+
+const Diagnostic& DiagnosticIndex::at(int index) const
+{
+    return diags_.at(index);
+}
+
+int DiagnosticIndex::firstOf(Diagnostic::Severity severity) const
+{
+    switch (severity) {
+    case Diagnostic::Error:
+        return firstError_;
+    case Diagnostic::Warning:
+        return firstWarning_;
+    default:
+        return -1;
+    }
+}
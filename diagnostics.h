@@ -0,0 +1,84 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+struct Diagnostic {
+    enum Severity {
+        None,
+        Note,
+        Warning,
+        Error,
+    };
+
+    Severity severity{None};
+    QString file;
+    int line{};
+    int column{};
+    QString code;
+    QString message;
+    int logLine{-1};   // 在日志中的行号，加入索引时确定
+    QString unit;      // 产生该诊断的编译单元（来自 ninja 状态行）
+    int group{-1};     // 去重分组，相同 (file, line, message) 的诊断同组
+};
+
+// 同一分组的诊断汇总：首次出现的位置、出现次数和涉及的编译单元
+struct DiagnosticGroup {
+    int first{-1};
+    int count{};
+    QStringList units;
+};
+
+// 编译器诊断的流式解析器，逐行识别 GCC/Clang/MSVC 文本格式，
+// CMake 的 Error/Warning at 行，以及 GCC/Clang 的 JSON、SARIF 单行输出（-fdiagnostics-format=json/sarif-stderr）。
+class DiagnosticParser
+{
+public:
+    DiagnosticParser();
+
+public:
+    bool parseLine(const QString& line, Diagnostic& diag) const;
+    bool parseStructured(const QString& line, QVector<Diagnostic>& diags) const;
+
+    static QString severityName(Diagnostic::Severity severity);
+    static QString format(const Diagnostic& diag);
+
+private:
+    QRegularExpression gccRe_;
+    QRegularExpression msvcRe_;
+    QRegularExpression cmakeRe_;
+};
+
+// 已解析诊断的索引，按出现顺序保存，记录每条诊断在日志中的位置；
+// 重复出现的诊断只累加到所在分组，不再单独保存
+class DiagnosticIndex
+{
+public:
+    void clear();
+    int add(const Diagnostic& diag);
+    const DiagnosticGroup* addDuplicate(const Diagnostic& diag);
+    const DiagnosticGroup* group(int id) const;
+    int duplicates() const;
+
+    int count() const;
+    int count(Diagnostic::Severity severity) const;
+    const Diagnostic& at(int index) const;
+    int firstOf(Diagnostic::Severity severity) const;
+
+private:
+    QVector<Diagnostic> diags_;
+    int errors_{};
+    int warnings_{};
+    int notes_{};
+    int firstError_{-1};
+    int firstWarning_{-1};
+    int duplicates_{};
+    QHash<int, DiagnosticGroup> groups_;
+    QHash<int, QSet<QString>> groupUnits_;
+};
+
+#endif
@@ -0,0 +1,229 @@
+#include "headless.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QThread>
+#include <QTimer>
+#include <cstdio>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+#include "builddaemon.h"
+#include "config.h"
+#include "jobqueue.h"
+#include "processrunner.h"
+
+namespace {
+
+void writeLine(const QString& text, bool isError = false)
+{
+    FILE* out = isError ? stderr : stdout;
+    QByteArray data = text.toLocal8Bit();
+    data += '\n';
+    fwrite(data.constData(), 1, static_cast<size_t>(data.size()), out);
+    fflush(out);
+}
+
+void attachConsole()
+{
+#ifdef Q_OS_WIN
+    // 程序按 WIN32 子系统链接，没有自己的控制台，输出到启动它的命令行窗口
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        freopen("CONOUT$", "w", stdout);
+        freopen("CONOUT$", "w", stderr);
+    }
+#endif
+}
+
+}   // namespace
+
+namespace Headless {
+
+bool requested(int argc, char* argv[])
+{
+    // 与 run 中定义的选项保持一致。Qt 自身的界面选项（-style、--platform、-reverse 等）
+    // 和 macOS 的 -psn_* 仍交给界面模式处理
+    static const QStringList longNames = {"help", "help-all", "list", "project", "configure", "build", "run",
+                                          "target", "mode", "generator", "jobs", "daemon", "socket"};
+    static const QStringList shortNames = {"h", "?", "p", "t", "m", "g", "j"};
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg.startsWith("--")) {
+            if (longNames.contains(arg.mid(2).section('=', 0, 0))) {
+                return true;
+            }
+        } else if (arg.startsWith('-') && shortNames.contains(arg.mid(1))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int run(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    attachConsole();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("cmakeBuilder 命令行模式，使用界面中保存的项目配置。\n"
+                                     "未指定 --configure/--build/--run 时执行配置和构建。");
+    parser.addHelpOption();
+    QCommandLineOption listOpt("list", "列出已保存的项目配置");
+    QCommandLineOption projectOpt(QStringList{"p", "project"}, "项目配置名称", "name");
+    QCommandLineOption configureOpt("configure", "执行 CMake 配置（配置未变化时跳过）");
+    QCommandLineOption buildOpt("build", "构建目标");
+    QCommandLineOption runOpt("run", "运行目标，目标为相对构建树的程序路径");
+    QCommandLineOption targetOpt(QStringList{"t", "target"}, "目标，默认使用保存的目标", "target");
+    QCommandLineOption modeOpt(QStringList{"m", "mode"}, "构建类型：Debug、Release 或 RelWithDebInfo", "mode");
+    QCommandLineOption generatorOpt(QStringList{"g", "generator"}, "生成器：Ninja 或 Ninja Multi-Config", "generator");
+    QCommandLineOption jobsOpt(QStringList{"j", "jobs"}, "构建使用的核心数", "n");
+    QCommandLineOption daemonOpt("daemon", "以守护进程方式运行，通过本地套接字接收 JSON 行请求");
+    QCommandLineOption socketOpt("socket", "守护进程监听的本地套接字名称", "name",
+                                 "cmakeBuilder-" + QDir::home().dirName());
+    parser.addOptions({listOpt, projectOpt, configureOpt, buildOpt, runOpt, targetOpt, modeOpt, generatorOpt, jobsOpt,
+                       daemonOpt, socketOpt});
+    parser.process(app);
+
+    BuilderConfig config;
+    config.setConfigDir(BuilderConfig::defaultDir() + "/config.json");
+    QObject::connect(&config, &BuilderConfig::sigMsg, [](const QString& msg) { writeLine(msg, true); });
+
+    int cores = parser.value(jobsOpt).toInt();
+    if (cores <= 0) {
+        cores = config.getJobCores();
+    }
+    if (cores <= 0) {
+        cores = QThread::idealThreadCount();
+    }
+
+    if (parser.isSet(daemonOpt)) {
+        BuildDaemon daemon(&config);
+        daemon.setCoreBudget(cores);
+        QString error;
+        if (!daemon.listen(parser.value(socketOpt), error)) {
+            writeLine("错误：" + error, true);
+            return 2;
+        }
+        writeLine("守护进程已启动，监听 " + parser.value(socketOpt));
+        return app.exec();
+    }
+
+    QVector<QString> keys;
+    config.GetAllKeys(keys);
+    if (parser.isSet(listOpt)) {
+        for (const QString& key : keys) {
+            writeLine(key);
+        }
+        return 0;
+    }
+
+    QString key = parser.value(projectOpt);
+    OneConfig o;
+    if (key.isEmpty() || !keys.contains(key) || !config.GetData(key, o)) {
+        writeLine(key.isEmpty() ? QString("错误：请用 --project 指定项目配置") : "错误：未找到项目配置 " + key, true);
+        writeLine("已保存的项目：" + QStringList::fromVector(keys).join(", "), true);
+        return 2;
+    }
+    if (parser.isSet(modeOpt)) {
+        o.curMode = parser.value(modeOpt);
+    }
+    if (parser.isSet(targetOpt)) {
+        o.curTarget = parser.value(targetOpt);
+    }
+    if (parser.isSet(generatorOpt)) {
+        o.curType = parser.value(generatorOpt);
+    }
+
+    QList<Job::Kind> kinds;
+    if (parser.isSet(configureOpt)) {
+        kinds << Job::Configure;
+    }
+    if (parser.isSet(buildOpt)) {
+        kinds << Job::Build;
+    }
+    if (parser.isSet(runOpt)) {
+        kinds << Job::Run;
+    }
+    if (kinds.isEmpty()) {
+        kinds << Job::Configure << Job::Build;
+    }
+
+    JobQueue queue;
+    queue.setCoreBudget(cores);
+
+    int exitCode = 0;
+    int lastFinished = -1;
+    auto drain = [&queue](int id) {
+        ProcessRunner* runner = queue.runner(id);
+        if (!runner) {
+            return;
+        }
+        QVector<OutputLine> lines;
+        runner->takeLines(lines);
+        for (const OutputLine& line : lines) {
+            if (!line.hidden) {
+                writeLine(line.text, line.isError);
+            }
+        }
+    };
+    QObject::connect(&queue, &JobQueue::sigJobOutput, drain);
+    QObject::connect(&queue, &JobQueue::sigJobProgress, [&queue, &lastFinished](int id) {
+        // ninja 状态行已折叠为进度，完成数变化时输出一行
+        NinjaProgress p = queue.runner(id)->takeProgress();
+        if (p.total > 0 && p.finished != lastFinished) {
+            lastFinished = p.finished;
+            writeLine(QString("[%1/%2]").arg(p.finished).arg(p.total));
+        }
+    });
+    QObject::connect(&queue, &JobQueue::sigJobChanged, [&queue, &exitCode, &lastFinished, drain](int id) {
+        const Job* job = queue.job(id);
+        QString name = JobQueue::kindName(job->kind);
+        if (job->state == Job::Running) {
+            lastFinished = -1;
+            if (!job->note.isEmpty()) {
+                writeLine(job->note);
+            }
+            writeLine(name + ": " + job->command);
+            return;
+        }
+        if (!job->isDone()) {
+            return;
+        }
+        // 读取剩余的输出
+        drain(id);
+        QString text = name + " " + JobQueue::stateName(job->state);
+        if (!job->error.isEmpty()) {
+            text += "：" + job->error;
+        } else if (job->state == Job::Succeeded && !job->note.isEmpty() && job->command.isEmpty()) {
+            text += "：" + job->note;
+        }
+        if (job->elapsedMs >= 0) {
+            text += QString("（耗时 %1 s）").arg(job->elapsedMs / 1000.0, 0, 'f', 1);
+        }
+        bool failed = job->state == Job::Failed || job->state == Job::Cancelled;
+        writeLine(text, failed);
+        if (failed && exitCode == 0) {
+            exitCode = job->exitCode != 0 ? job->exitCode : 1;
+        }
+    });
+
+    // 进入事件循环后再提交；全部任务提交后才监听结束，
+    // 避免前一个任务（例如跳过的配置）同步结束时提前退出
+    QTimer::singleShot(0, &queue, [&app, &queue, &o, &kinds]() {
+        QList<int> deps;
+        for (Job::Kind kind : kinds) {
+            deps = {queue.add(kind, o, deps)};
+        }
+        QObject::connect(&queue, &JobQueue::sigIdle, &app, &QCoreApplication::quit);
+        if (queue.isIdle()) {
+            app.quit();
+        }
+    });
+    app.exec();
+    return exitCode;
+}
+
+}   // namespace Headless
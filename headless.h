@@ -0,0 +1,16 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// 无界面的命令行模式：读取界面保存的 config.json，对指定项目执行配置、构建和运行，
+// 输出直接写到 stdout/stderr，返回 cmake 的退出码。不创建 QApplication，启动更快。
+//   cmakeBuilder --project X --configure --build --target Y --mode Release
+//   cmakeBuilder --daemon [--socket name]   常驻并通过本地套接字接收请求，见 BuildDaemon
+namespace Headless {
+
+// 带有命令行模式自己的选项（--project、--list、--daemon、--help 等）时进入命令行模式，其余参数留给界面
+bool requested(int argc, char* argv[]);
+int run(int argc, char* argv[]);
+
+}   // namespace Headless
+
+#endif
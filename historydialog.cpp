@@ -0,0 +1,258 @@
+#include "historydialog.h"
+
+#include <QComboBox>
+#include <QDateTime>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QSplitter>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <algorithm>
+
+namespace {
+
+// 比较时最多列出的边数
+constexpr int MAX_DIFF_ROWS = 200;
+// 比基线快 15% 以上时标为改善
+constexpr double IMPROVEMENT_RATIO = 1.15;
+
+QString seconds(qint64 ms)
+{
+    return QString::number(ms / 1000.0, 'f', 2);
+}
+
+QString kindText(const QString& kind)
+{
+    return kind == "configure" ? QString("配置") : QString("构建");
+}
+
+}   // namespace
+
+HistoryDialog::HistoryDialog(BuildHistory* history, const QString& project, QWidget* parent)
+    : QDialog(parent), history_(history)
+{
+    setWindowTitle("构建历史");
+    setWindowFlags(windowFlags() | Qt::WindowMinMaxButtonsHint);
+    resize(1000, 640);
+
+    cbProject_ = new QComboBox(this);
+    cbProject_->addItems(history_->projects());
+    if (cbProject_->findText(project) < 0 && !project.isEmpty()) {
+        cbProject_->addItem(project);
+    }
+    cbProject_->setCurrentText(project);
+    cbKey_ = new QComboBox(this);
+    cbKey_->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    QPushButton* btnCompare = new QPushButton("比较所选的两次构建", this);
+
+    QHBoxLayout* top = new QHBoxLayout();
+    top->addWidget(new QLabel("项目：", this));
+    top->addWidget(cbProject_);
+    top->addWidget(new QLabel("记录：", this));
+    top->addWidget(cbKey_);
+    top->addStretch();
+    top->addWidget(btnCompare);
+
+    twRecords_ = new QTreeWidget(this);
+    twRecords_->setRootIsDecorated(false);
+    twRecords_->setUniformRowHeights(true);
+    twRecords_->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    twRecords_->setHeaderLabels(
+        {"时间", "类型", "模式", "目标", "提交", "结果", "墙钟 (s)", "CPU (s)", "步骤", "基线 (s)", "相对基线"});
+
+    QWidget* diffPage = new QWidget(this);
+    QVBoxLayout* diffLayout = new QVBoxLayout(diffPage);
+    diffLayout->setContentsMargins(0, 0, 0, 0);
+    lbDiff_ = new QLabel("选择两条带有步骤耗时的构建记录后点击比较", diffPage);
+    twDiff_ = new QTreeWidget(diffPage);
+    twDiff_->setRootIsDecorated(false);
+    twDiff_->setUniformRowHeights(true);
+    twDiff_->setHeaderLabels({"输出", "较早 (s)", "较新 (s)", "变化 (s)"});
+    twDiff_->setColumnWidth(0, 520);
+    diffLayout->addWidget(lbDiff_);
+    diffLayout->addWidget(twDiff_);
+
+    QSplitter* splitter = new QSplitter(Qt::Vertical, this);
+    splitter->addWidget(twRecords_);
+    splitter->addWidget(diffPage);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 2);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addLayout(top);
+    layout->addWidget(splitter);
+
+    connect(cbProject_, &QComboBox::currentTextChanged, this, [this]() { LoadProject(); });
+    connect(cbKey_, &QComboBox::currentTextChanged, this, [this]() { ShowRecords(); });
+    connect(btnCompare, &QPushButton::clicked, this, &HistoryDialog::CompareSelected);
+    LoadProject();
+}
+
+void HistoryDialog::LoadProject()
+{
+    records_ = history_->load(cbProject_->currentText());
+
+    // 按模式、目标和类型筛选，只有同一组内的记录计算基线
+    QStringList keys;
+    for (const HistoryRecord& r : records_) {
+        QString text = kindText(r.kind) + " " + r.mode + (r.target.isEmpty() ? QString() : " " + r.target);
+        if (!keys.contains(text)) {
+            keys << text;
+        }
+    }
+    cbKey_->blockSignals(true);
+    cbKey_->clear();
+    cbKey_->addItem("全部");
+    cbKey_->addItems(keys);
+    cbKey_->blockSignals(false);
+    ShowRecords();
+}
+
+void HistoryDialog::ShowRecords()
+{
+    twRecords_->clear();
+    twDiff_->clear();
+    QString filter = cbKey_->currentIndex() > 0 ? cbKey_->currentText() : QString();
+
+    int regressions = 0;
+    for (int i = records_.size() - 1; i >= 0; --i) {
+        const HistoryRecord& r = records_.at(i);
+        QString text = kindText(r.kind) + " " + r.mode + (r.target.isEmpty() ? QString() : " " + r.target);
+        if (!filter.isEmpty() && text != filter) {
+            continue;
+        }
+
+        qint64 base = r.success ? BuildHistory::baseline(records_, i) : -1;
+        QString change;
+        if (base > 0) {
+            change = QString("%1%2%").arg(r.wallMs >= base ? "+" : "").arg(100.0 * (r.wallMs - base) / base, 0, 'f', 0);
+        }
+        QStringList columns;
+        columns << QDateTime::fromMSecsSinceEpoch(r.time).toString("yyyy-MM-dd hh:mm:ss") << kindText(r.kind) << r.mode
+                << r.target << r.commit << (r.success ? QString("成功") : QString("失败（%1）").arg(r.exitCode))
+                << seconds(r.wallMs) << (r.kind == "build" ? seconds(r.cpuMs) : QString())
+                << (r.kind == "build" ? QString::number(r.edges) : QString()) << (base > 0 ? seconds(base) : QString())
+                << change;
+        QTreeWidgetItem* item = new QTreeWidgetItem(twRecords_, columns);
+        item->setData(0, Qt::UserRole, i);
+        for (int c = 6; c < columns.size(); ++c) {
+            item->setTextAlignment(c, Qt::AlignRight | Qt::AlignVCenter);
+        }
+
+        QStringList tip;
+        if (r.kind == "build") {
+            tip << QString("并行度 %1，关键路径 %2 s").arg(r.parallelism, 0, 'f', 2).arg(seconds(r.criticalMs));
+        }
+        for (const auto& s : r.slowest) {
+            tip << seconds(s.second) + " s  " + s.first;
+        }
+        item->setToolTip(0, tip.join("\n"));
+
+        if (!r.success) {
+            item->setForeground(5, QBrush(QColor(200, 0, 0)));
+        }
+        if (BuildHistory::isRegression(r.wallMs, base)) {
+            ++regressions;
+            item->setText(10, "回归 " + change);
+            for (int c = 0; c < columns.size(); ++c) {
+                item->setForeground(c, QBrush(QColor(200, 0, 0)));
+            }
+        } else if (base > 0 && r.wallMs * IMPROVEMENT_RATIO < base) {
+            item->setForeground(10, QBrush(QColor(0, 140, 0)));
+        }
+    }
+    for (int c = 0; c < twRecords_->columnCount(); ++c) {
+        twRecords_->resizeColumnToContents(c);
+    }
+    twRecords_->headerItem()->setText(10, regressions > 0 ? QString("相对基线（回归 %1）").arg(regressions) : QString("相对基线"));
+}
+
+void HistoryDialog::CompareSelected()
+{
+    QList<QTreeWidgetItem*> selected = twRecords_->selectedItems();
+    if (selected.size() != 2) {
+        lbDiff_->setText("请选择两条构建记录");
+        return;
+    }
+    int a = selected.at(0)->data(0, Qt::UserRole).toInt();
+    int b = selected.at(1)->data(0, Qt::UserRole).toInt();
+    if (a > b) {
+        std::swap(a, b);
+    }
+    QHash<QString, qint64> older = history_->edges(records_.at(a));
+    QHash<QString, qint64> newer = history_->edges(records_.at(b));
+    if (older.isEmpty() || newer.isEmpty()) {
+        lbDiff_->setText("所选记录没有步骤耗时（配置记录或没有执行任何步骤的构建）");
+        twDiff_->clear();
+        return;
+    }
+
+    struct Row {
+        QString output;
+        qint64 older;
+        qint64 newer;
+    };
+    QVector<Row> rows;
+    int onlyOlder = 0;
+    int onlyNewer = 0;
+    qint64 total = 0;
+    for (auto it = older.constBegin(); it != older.constEnd(); ++it) {
+        auto other = newer.constFind(it.key());
+        if (other == newer.constEnd()) {
+            ++onlyOlder;
+            rows.append(Row{it.key(), it.value(), -1});
+        } else {
+            total += other.value() - it.value();
+            rows.append(Row{it.key(), it.value(), other.value()});
+        }
+    }
+    for (auto it = newer.constBegin(); it != newer.constEnd(); ++it) {
+        if (!older.contains(it.key())) {
+            ++onlyNewer;
+            rows.append(Row{it.key(), -1, it.value()});
+        }
+    }
+    // 两边都有的按变化量排序，只在一边执行的按耗时排在其后
+    auto weight = [](const Row& r) { return r.older >= 0 && r.newer >= 0 ? qAbs(r.newer - r.older) : -1; };
+    std::sort(rows.begin(), rows.end(), [&weight](const Row& x, const Row& y) -> bool {
+        qint64 wx = weight(x);
+        qint64 wy = weight(y);
+        if (wx != wy) {
+            return wx > wy;
+        }
+        return qMax(x.older, x.newer) > qMax(y.older, y.newer);
+    });
+
+    twDiff_->clear();
+    for (int i = 0; i < rows.size() && i < MAX_DIFF_ROWS; ++i) {
+        const Row& r = rows.at(i);
+        QString diff;
+        if (r.older >= 0 && r.newer >= 0) {
+            diff = (r.newer >= r.older ? "+" : "-") + seconds(qAbs(r.newer - r.older));
+        }
+        QTreeWidgetItem* item = new QTreeWidgetItem(
+            twDiff_, QStringList{r.output, r.older >= 0 ? seconds(r.older) : QString("-"), r.newer >= 0 ? seconds(r.newer) : QString("-"), diff});
+        for (int c = 1; c < 4; ++c) {
+            item->setTextAlignment(c, Qt::AlignRight | Qt::AlignVCenter);
+        }
+        if (r.older >= 0 && r.newer > r.older) {
+            item->setForeground(3, QBrush(QColor(200, 0, 0)));
+        } else if (r.newer >= 0 && r.newer < r.older) {
+            item->setForeground(3, QBrush(QColor(0, 140, 0)));
+        }
+    }
+
+    const HistoryRecord& ra = records_.at(a);
+    const HistoryRecord& rb = records_.at(b);
+    lbDiff_->setText(QString("%1 (%2) -> %3 (%4)：共同 %5 个步骤合计 %6%7 s，仅较早执行 %8 个，仅较新执行 %9 个")
+                         .arg(QDateTime::fromMSecsSinceEpoch(ra.time).toString("MM-dd hh:mm"))
+                         .arg(ra.commit.isEmpty() ? QString("-") : ra.commit)
+                         .arg(QDateTime::fromMSecsSinceEpoch(rb.time).toString("MM-dd hh:mm"))
+                         .arg(rb.commit.isEmpty() ? QString("-") : rb.commit)
+                         .arg(older.size() - onlyOlder)
+                         .arg(total >= 0 ? "+" : "-")
+                         .arg(seconds(qAbs(total)))
+                         .arg(onlyOlder)
+                         .arg(onlyNewer));
+}
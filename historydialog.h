@@ -0,0 +1,35 @@
+#ifndef HISTORYDIALOG_H
+#define HISTORYDIALOG_H
+
+#include <QDialog>
+
+#include "buildhistory.h"
+
+class QComboBox;
+class QLabel;
+class QTreeWidget;
+
+// 构建历史：按项目列出配置和构建记录，标出相对滚动基线的回归，并比较两次构建各条边的耗时
+class HistoryDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    HistoryDialog(BuildHistory* history, const QString& project, QWidget* parent = nullptr);
+
+private:
+    void LoadProject();
+    void ShowRecords();
+    void CompareSelected();
+
+private:
+    BuildHistory* history_{};
+    QComboBox* cbProject_{};
+    QComboBox* cbKey_{};
+    QTreeWidget* twRecords_{};
+    QTreeWidget* twDiff_{};
+    QLabel* lbDiff_{};
+    QVector<HistoryRecord> records_;
+};
+
+#endif
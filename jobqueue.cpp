@@ -0,0 +1,534 @@
+#include "jobqueue.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+#include "cmakeargs.h"
+#include "processrunner.h"
+#include "vcenv.h"
+
+namespace {
+
+QString normalizedDir(const QString& dir)
+{
+    return QDir::cleanPath(QDir(dir).absolutePath());
+}
+
+QString jobTree(const Job& job)
+{
+    return normalizedDir(CMakeArgs::buildTree(job.config.buildDir, job.config.curType, job.mode));
+}
+
+// 按 QProcess::splitCommand 的规则拆分程序参数：空白分隔，双引号内保留空白，连续三个双引号表示一个双引号字符
+QStringList splitArguments(const QString& command)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    return QProcess::splitCommand(command);
+#else
+    QStringList args;
+    QString arg;
+    int quoteCount = 0;
+    bool inQuote = false;
+    for (int i = 0; i < command.size(); ++i) {
+        QChar c = command.at(i);
+        if (c == '"') {
+            ++quoteCount;
+            if (quoteCount == 3) {
+                quoteCount = 0;
+                arg += c;
+            }
+            continue;
+        }
+        if (quoteCount) {
+            if (quoteCount == 1) {
+                inQuote = !inQuote;
+            }
+            quoteCount = 0;
+        }
+        if (!inQuote && c.isSpace()) {
+            if (!arg.isEmpty()) {
+                args += arg;
+                arg.clear();
+            }
+        } else {
+            arg += c;
+        }
+    }
+    if (!arg.isEmpty()) {
+        args += arg;
+    }
+    return args;
+#endif
+}
+
+}   // namespace
+
+JobQueue::JobQueue(QObject* parent) : QObject(parent)
+{
+    clock_.start();
+}
+
+JobQueue::~JobQueue()
+{
+}
+
+void JobQueue::setCoreBudget(int cores)
+{
+    budget_ = qMax(1, cores);
+    schedule();
+}
+
+int JobQueue::coreBudget() const
+{
+    return budget_;
+}
+
+void JobQueue::setUsePty(bool use)
+{
+    usePty_ = use;
+}
+
+int JobQueue::add(Job::Kind kind, const OneConfig& config, const QList<int>& dependsOn)
+{
+    Job job;
+    job.id = nextId_++;
+    job.kind = kind;
+    job.config = config;
+    job.mode = config.curMode.isEmpty() ? QString("Debug") : config.curMode;
+    job.target = config.curTarget.isEmpty() ? QString("all") : config.curTarget;
+    job.dependsOn = dependsOn;
+    jobs_.insert(job.id, job);
+    busy_ = true;
+
+    emit sigJobAdded(job.id);
+    schedule();
+    return job.id;
+}
+
+QList<int> JobQueue::addChain(const OneConfig& config, bool run)
+{
+    QList<int> ids;
+    ids << add(Job::Configure, config);
+    ids << add(Job::Build, config, {ids.last()});
+    if (run) {
+        ids << add(Job::Run, config, {ids.last()});
+    }
+    return ids;
+}
+
+void JobQueue::suspend()
+{
+    ++suspended_;
+}
+
+void JobQueue::resume()
+{
+    if (suspended_ > 0 && --suspended_ == 0) {
+        schedule();
+    }
+}
+
+void JobQueue::cancel(int id)
+{
+    auto it = jobs_.find(id);
+    if (it == jobs_.end() || it->isDone()) {
+        return;
+    }
+
+    Job& job = it.value();
+    if (job.state == Job::Pending) {
+        job.state = Job::Cancelled;
+        emit sigJobChanged(id);
+        schedule();
+        return;
+    }
+
+    // 准备环境中的任务等环境就绪后再结束，运行中的任务等进程组全部退出
+    job.cancelRequested = true;
+    if (job.state == Job::Running && job.runner) {
+        job.runner->cancel();
+    }
+    emit sigJobChanged(id);
+}
+
+void JobQueue::cancelAll()
+{
+    // 先取消等待中的任务，避免运行中的任务结束时又调度起新任务
+    for (auto it = jobs_.begin(); it != jobs_.end(); ++it) {
+        if (it->state == Job::Pending) {
+            it->state = Job::Cancelled;
+            emit sigJobChanged(it->id);
+        }
+    }
+    for (int id : jobs_.keys()) {
+        cancel(id);
+    }
+    schedule();
+}
+
+bool JobQueue::remove(int id)
+{
+    auto it = jobs_.find(id);
+    if (it == jobs_.end() || !it->isDone()) {
+        return false;
+    }
+    if (it->runner) {
+        it->runner->deleteLater();
+    }
+    jobs_.erase(it);
+    startMs_.remove(id);
+    return true;
+}
+
+const Job* JobQueue::job(int id) const
+{
+    auto it = jobs_.constFind(id);
+    return it == jobs_.constEnd() ? nullptr : &it.value();
+}
+
+QList<int> JobQueue::ids() const
+{
+    return jobs_.keys();
+}
+
+ProcessRunner* JobQueue::runner(int id) const
+{
+    const Job* j = job(id);
+    return j ? j->runner : nullptr;
+}
+
+bool JobQueue::isIdle() const
+{
+    for (const Job& job : jobs_) {
+        if (!job.isDone()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool JobQueue::isDirBusy(const QString& buildDir) const
+{
+    QString dir = normalizedDir(buildDir);
+    for (const Job& job : jobs_) {
+        if (job.isActive() && jobTree(job) == dir) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobQueue::setExternalTask(const QString& buildDir, int cores)
+{
+    externalDir_ = buildDir.isEmpty() ? QString() : normalizedDir(buildDir);
+    externalCores_ = buildDir.isEmpty() ? 0 : qMax(1, cores);
+    schedule();
+}
+
+QString JobQueue::kindName(Job::Kind kind)
+{
+    switch (kind) {
+    case Job::Configure:
+        return "配置";
+    case Job::Build:
+        return "构建";
+    case Job::Run:
+        return "运行";
+    }
+    return QString();
+}
+
+QString JobQueue::stateName(Job::State state)
+{
+    switch (state) {
+    case Job::Pending:
+        return "等待";
+    case Job::Preparing:
+        return "准备环境";
+    case Job::Running:
+        return "运行中";
+    case Job::Succeeded:
+        return "成功";
+    case Job::Failed:
+        return "失败";
+    case Job::Cancelled:
+        return "已取消";
+    case Job::Skipped:
+        return "已跳过";
+    }
+    return QString();
+}
+
+int JobQueue::usedCores() const
+{
+    int used = externalCores_;
+    for (const Job& job : jobs_) {
+        if (job.isActive()) {
+            used += job.cores;
+        }
+    }
+    return used;
+}
+
+bool JobQueue::ready(const Job& job, bool& broken) const
+{
+    broken = false;
+    for (int dep : job.dependsOn) {
+        const Job* d = this->job(dep);
+        // 已被移除的依赖只可能是已结束的任务，按满足处理
+        if (!d || d->state == Job::Succeeded) {
+            continue;
+        }
+        if (d->isDone()) {
+            broken = true;
+        }
+        return false;
+    }
+    return true;
+}
+
+void JobQueue::schedule()
+{
+    if (suspended_ > 0) {
+        return;
+    }
+    // 启动前就失败的任务会让依赖它的任务跳过、核心重新空出，需要再调度一轮
+    bool again = true;
+    while (again) {
+        again = scheduleOnce();
+    }
+
+    bool idle = isIdle();
+    if (idle && busy_) {
+        emit sigIdle();
+    }
+    busy_ = !idle;
+}
+
+bool JobQueue::scheduleOnce()
+{
+    // 依赖失败的任务直接跳过，跳过会继续传递给依赖它的任务
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto it = jobs_.begin(); it != jobs_.end(); ++it) {
+            bool broken = false;
+            if (it->state == Job::Pending && !ready(*it, broken) && broken) {
+                it->state = Job::Skipped;
+                emit sigJobChanged(it->id);
+                changed = true;
+            }
+        }
+    }
+
+    // 按提交顺序挑出可以开始的任务，同一构建目录只取最早的一个
+    QList<int> candidates;
+    QStringList dirs;
+    for (const Job& job : jobs_) {
+        bool broken = false;
+        if (job.state != Job::Pending || !ready(job, broken)) {
+            continue;
+        }
+        QString dir = jobTree(job);
+        if (dirs.contains(dir) || dir == externalDir_ || isDirBusy(dir)) {
+            continue;
+        }
+        dirs << dir;
+        candidates << job.id;
+    }
+
+    bool again = false;
+    int builds = 0;
+    for (int id : candidates) {
+        if (jobs_[id].kind == Job::Build) {
+            ++builds;
+        }
+    }
+
+    for (int id : candidates) {
+        Job& job = jobs_[id];
+        int used = usedCores();
+        int free = budget_ - used;
+        // 预算用尽时只在完全空闲的情况下放行一个任务，保证队列总能前进
+        if (free <= 0 && used > 0) {
+            break;
+        }
+        int cores = 1;
+        if (job.kind == Job::Build) {
+            // 空闲核心在待开始的构建之间平分
+            cores = qMax(1, free / qMax(1, builds));
+            --builds;
+        }
+        job.cores = cores;
+        launch(job);
+        if (job.isDone()) {
+            again = true;
+        }
+    }
+    return again;
+}
+
+void JobQueue::launch(Job& job)
+{
+    int id = job.id;
+    job.state = Job::Preparing;
+    job.cancelRequested = false;
+    if (!job.runner) {
+        job.runner = new ProcessRunner(this);
+        connect(job.runner, &ProcessRunner::sigOutput, this, [this, id]() { emit sigJobOutput(id); });
+        connect(job.runner, &ProcessRunner::sigProgress, this, [this, id]() { emit sigJobProgress(id); });
+        connect(job.runner, &ProcessRunner::sigFinished, this,
+                [this, id](int exitCode, QProcess::ExitStatus exitStatus) { finish(id, exitCode, exitStatus); });
+        connect(job.runner, &ProcessRunner::sigError, this, [this, id](QProcess::ProcessError error) {
+            // 启动失败不会再有 sigFinished
+            auto it = jobs_.find(id);
+            if (error == QProcess::FailedToStart && it != jobs_.end() && it->isActive()) {
+                fail(it.value(), "进程启动失败，请检查程序路径是否正确");
+                schedule();
+            }
+        });
+    }
+    job.runner->setUsePty(usePty_);
+    startMs_.insert(id, clock_.elapsed());
+    emit sigJobChanged(id);
+
+    QString envBat = job.config.vcEnv;
+    if (envBat.isEmpty()) {
+        startProcess(id, QProcessEnvironment::systemEnvironment());
+        return;
+    }
+    if (!QFile::exists(envBat)) {
+        fail(job, "VC环境脚本不存在: " + envBat);
+        return;
+    }
+
+    // 捕获 VC 环境需要数秒，放到线程池中，界面和其他任务不受影响
+    auto* watcher = new QFutureWatcher<QPair<QProcessEnvironment, QString>>(this);
+    connect(watcher, &QFutureWatcher<QPair<QProcessEnvironment, QString>>::finished, this, [this, id, watcher]() {
+        QPair<QProcessEnvironment, QString> result = watcher->result();
+        watcher->deleteLater();
+
+        auto it = jobs_.find(id);
+        if (it == jobs_.end() || it->state != Job::Preparing) {
+            return;
+        }
+        if (it->cancelRequested) {
+            it->state = Job::Cancelled;
+            it->cores = 0;
+            emit sigJobChanged(id);
+        } else if (result.first.isEmpty()) {
+            fail(it.value(), "获取VC环境变量失败: " + result.second);
+        } else {
+            startProcess(id, result.first);
+        }
+        schedule();
+    });
+    watcher->setFuture(QtConcurrent::run([envBat]() {
+        QString error;
+        QProcessEnvironment env = VcEnvironment::capture(envBat, &error);
+        return qMakePair(env, error);
+    }));
+}
+
+void JobQueue::startProcess(int id, const QProcessEnvironment& env)
+{
+    Job& job = jobs_[id];
+    const OneConfig& o = job.config;
+
+    QString program;
+    QStringList arguments;
+    QStringList warnings;
+    QString tree = CMakeArgs::buildTree(o.buildDir, o.curType, job.mode);
+    QString workDir = tree;
+    QProcessEnvironment runEnv = env;
+
+    switch (job.kind) {
+    case Job::Configure:
+        if (!QDir().mkpath(tree)) {
+            fail(job, "无法创建构建目录 " + tree);
+            return;
+        }
+        program = o.cmakePath;
+        arguments = CMakeArgs::configure(o, job.mode, env);
+        warnings = CMakeArgs::configureWarnings(o, job.mode, env);
+        job.fingerprint = ConfigFingerprint::compute(program, arguments, env);
+        if (ConfigFingerprint::upToDate(tree, CMakeArgs::ninjaFile(o.buildDir, o.curType, job.mode), job.fingerprint,
+                                        job.note)) {
+            job.note = (warnings << "配置未变化，跳过 CMake 配置（" + job.note + "）").join('\n');
+            job.state = Job::Succeeded;
+            job.cores = 0;
+            job.elapsedMs = clock_.elapsed() - startMs_.value(id);
+            emit sigJobChanged(id);
+            return;
+        }
+        job.note = (warnings << "执行 CMake 配置：" + job.note).join('\n');
+        ConfigFingerprint::invalidate(tree);
+        break;
+    case Job::Build:
+        if (!QFile::exists(tree + "/CMakeCache.txt")) {
+            fail(job, "项目未配置，请先执行 CMake 配置");
+            return;
+        }
+        program = o.cmakePath;
+        arguments = CMakeArgs::build(o, job.mode, job.target, job.cores);
+        runEnv = CMakeArgs::buildEnvironment(env);
+        break;
+    case Job::Run: {
+        QFileInfo fileInfo(QDir::cleanPath(QDir(tree).absoluteFilePath(job.target)));
+        if (!fileInfo.isFile()) {
+            fail(job, "目标程序不存在: " + fileInfo.filePath());
+            return;
+        }
+        program = fileInfo.absoluteFilePath();
+        arguments = splitArguments(o.arg);
+        workDir = fileInfo.absolutePath();
+        break;
+    }
+    }
+
+    job.command = program + " " + arguments.join(" ");
+    job.state = Job::Running;
+    job.runner->setWorkingDirectory(workDir);
+    job.runner->setProcessEnvironment(runEnv);
+    emit sigJobChanged(id);
+    job.runner->start(program, arguments);
+}
+
+void JobQueue::finish(int id, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    auto it = jobs_.find(id);
+    if (it == jobs_.end() || !it->isActive()) {
+        return;
+    }
+
+    Job& job = it.value();
+    job.exitCode = exitCode;
+    if (job.cancelRequested) {
+        job.state = Job::Cancelled;
+    } else if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+        job.state = Job::Succeeded;
+        if (job.kind == Job::Configure) {
+            ConfigFingerprint::save(CMakeArgs::buildTree(job.config.buildDir, job.config.curType, job.mode), job.fingerprint);
+        }
+    } else {
+        job.state = Job::Failed;
+        job.error = exitStatus == QProcess::NormalExit ? "退出码: " + QString::number(exitCode) : "进程异常退出";
+    }
+    job.cores = 0;
+    job.elapsedMs = clock_.elapsed() - startMs_.value(id);
+    emit sigJobChanged(id);
+    schedule();
+}
+
+void JobQueue::fail(Job& job, const QString& error)
+{
+    job.state = Job::Failed;
+    job.error = error;
+    job.cores = 0;
+    if (startMs_.contains(job.id)) {
+        job.elapsedMs = clock_.elapsed() - startMs_.value(job.id);
+    }
+    emit sigJobChanged(job.id);
+}
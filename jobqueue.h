@@ -0,0 +1,115 @@
+#ifndef JOBQUEUE_H
+#define JOBQUEUE_H
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <QProcess>
+
+#include "config.h"
+#include "configfingerprint.h"
+
+class ProcessRunner;
+
+struct Job {
+    enum Kind { Configure, Build, Run };
+    enum State { Pending, Preparing, Running, Succeeded, Failed, Cancelled, Skipped };
+
+    int id{};
+    Kind kind{Build};
+    OneConfig config;
+    QString mode;
+    QString target;
+    QList<int> dependsOn;   // 全部成功后才开始，任一失败则跳过
+    State state{Pending};
+    int cores{};            // 占用的核心预算
+    int exitCode{};
+    bool cancelRequested{};
+    QString command;
+    QString error;
+    QString note;           // 附加说明，可能有多行，例如配置前的警告、配置未变化而跳过的原因
+    ConfigFingerprint::Fingerprint fingerprint;
+    qint64 elapsedMs{-1};
+    ProcessRunner* runner{};
+
+    bool isActive() const
+    {
+        return state == Preparing || state == Running;
+    }
+    bool isDone() const
+    {
+        return state >= Succeeded;
+    }
+};
+
+// 配置/构建/运行任务队列：依赖满足、核心预算有余、且构建目录未被占用的任务同时运行。
+// 每个任务使用独立的 ProcessRunner，输出和进度由调用方按任务 id 取走。
+// 构建任务按空闲核心分配 --parallel，配置和运行任务各占一个核心；
+// 同一构建目录上的任务总是串行，也不与界面自身正在运行的任务重叠，避免两个 cmake 同时改写同一棵构建树；
+// 配置指纹未变化的配置任务不启动进程，直接视为成功。
+class JobQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    JobQueue(QObject* parent = nullptr);
+    ~JobQueue();
+
+public:
+    void setCoreBudget(int cores);
+    int coreBudget() const;
+    void setUsePty(bool use);
+    int add(Job::Kind kind, const OneConfig& config, const QList<int>& dependsOn = QList<int>());
+    // 配置 -> 构建 [-> 运行]，返回各任务 id
+    QList<int> addChain(const OneConfig& config, bool run);
+    // 暂停调度，add 只登记任务；调用方需要先处理完返回的 id（如回复提交者）再让任务开始时使用。
+    // 可以嵌套，最后一次 resume 时统一调度
+    void suspend();
+    void resume();
+    void cancel(int id);
+    void cancelAll();
+    // 移除已结束的任务并释放其进程资源
+    bool remove(int id);
+    const Job* job(int id) const;
+    QList<int> ids() const;
+    ProcessRunner* runner(int id) const;
+    bool isIdle() const;
+    // 构建目录是否正被某个任务使用
+    bool isDirBusy(const QString& buildDir) const;
+    // 队列之外正在运行的配置或构建（界面自身的任务）：占用的构建目录不调度任务，核心计入预算；
+    // buildDir 为空表示已结束，随即调度等待中的任务
+    void setExternalTask(const QString& buildDir, int cores);
+    static QString kindName(Job::Kind kind);
+    static QString stateName(Job::State state);
+
+Q_SIGNALS:
+    void sigJobAdded(int id);
+    void sigJobChanged(int id);
+    void sigJobOutput(int id);
+    void sigJobProgress(int id);
+    void sigIdle();
+
+private:
+    void schedule();
+    bool scheduleOnce();
+    void launch(Job& job);
+    void startProcess(int id, const QProcessEnvironment& env);
+    void finish(int id, int exitCode, QProcess::ExitStatus exitStatus);
+    void fail(Job& job, const QString& error);
+    int usedCores() const;
+    bool ready(const Job& job, bool& broken) const;
+
+private:
+    QMap<int, Job> jobs_;
+    int nextId_{1};
+    int budget_{1};
+    bool usePty_{};
+    bool busy_{};
+    int suspended_{};
+    QString externalDir_;
+    int externalCores_{};
+    QElapsedTimer clock_;
+    QMap<int, qint64> startMs_;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "linesplitter.h"
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QByteArrayView>
+#else
+#include <QTextCodec>
+#include <QTextDecoder>
+#endif
+
+LineSplitter::LineSplitter()
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    : decoder_(QStringDecoder::Utf8)
+#endif
+{
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    decoder_ = QTextCodec::codecForName("UTF-8")->makeDecoder();
+#endif
+}
+
+LineSplitter::~LineSplitter()
+{
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    delete decoder_;
+#endif
+}
+
+void LineSplitter::reset()
+{
+    partial_.clear();
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    decoder_.resetState();
+#else
+    delete decoder_;
+    decoder_ = QTextCodec::codecForName("UTF-8")->makeDecoder();
+#endif
+}
+
+void LineSplitter::feed(const QByteArray& data, QStringList& lines)
+{
+    int from = 0;
+    int newlinePos;
+    while ((newlinePos = data.indexOf('\n', from)) != -1) {
+        if (partial_.isEmpty()) {
+            emitLine(data.constData() + from, newlinePos - from, lines);
+        } else {
+            partial_.append(data.constData() + from, newlinePos - from);
+            emitLine(partial_.constData(), partial_.size(), lines);
+            partial_.clear();
+        }
+        from = newlinePos + 1;
+    }
+
+    // 剩余的是不完整的行
+    if (from < data.size()) {
+        partial_.append(data.constData() + from, data.size() - from);
+    }
+}
+
+void LineSplitter::finish(QStringList& lines)
+{
+    if (!partial_.isEmpty()) {
+        emitLine(partial_.constData(), partial_.size(), lines);
+        partial_.clear();
+    }
+}
+
+void LineSplitter::emitLine(const char* data, int size, QStringList& lines)
+{
+    // 去掉行尾的 \r 和空白，保留行首缩进（诊断信息的 ^ 标记依赖它对齐）
+    while (size > 0 && (data[size - 1] == '\r' || data[size - 1] == ' ' || data[size - 1] == '\t')) {
+        --size;
+    }
+    if (size == 0) {
+        return;
+    }
+
+    // 优先按 UTF-8 解码，不合法时退回本地编码（如 MSVC 输出的 GBK）。
+    // 传入的总是完整的一行，多字节字符不会在这里被切开，解码出错即整行不是 UTF-8
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QString line = decoder_.decode(QByteArrayView(data, size));
+    if (decoder_.hasError()) {
+        decoder_.resetState();
+        line = QString::fromLocal8Bit(data, size);
+    }
+#else
+    QString line = decoder_->toUnicode(data, size);
+    if (decoder_->hasFailure()) {
+        delete decoder_;
+        decoder_ = QTextCodec::codecForName("UTF-8")->makeDecoder();
+        line = QString::fromLocal8Bit(data, size);
+    }
+#endif
+    lines.append(line);
+}
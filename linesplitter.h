@@ -0,0 +1,43 @@
+#ifndef LINESPLITTER_H
+#define LINESPLITTER_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QtGlobal>
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QStringDecoder>
+#else
+class QTextDecoder;
+#endif
+
+// 进程输出的流式分行器，每个进程的每个通道各用一个实例。
+// 按原始字节查找换行，不完整的行以字节形式保留到下一次读取，解码器每次只拿到完整的一行。
+// 跨读取边界的 UTF-8/GBK 多字节字符正是因此不会被截断，并不依赖解码器在两次调用之间保存状态；
+// 整体为线性复杂度。
+class LineSplitter
+{
+public:
+    LineSplitter();
+    ~LineSplitter();
+
+public:
+    void reset();
+    void feed(const QByteArray& data, QStringList& lines);
+    void finish(QStringList& lines);
+
+private:
+    void emitLine(const char* data, int size, QStringList& lines);
+
+private:
+    QByteArray partial_;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QStringDecoder decoder_;
+#else
+    QTextDecoder* decoder_{};
+#endif
+
+    Q_DISABLE_COPY(LineSplitter)
+};
+
+#endif
@@ -0,0 +1,287 @@
+#include "logindex.h"
+
+#include <algorithm>
+
+#include "logstore.h"
+
+// 倒排表的粒度：每个行块包含的行数
+constexpr int BLOCK_LINES = 32;
+
+static inline char foldAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+void LogIndex::clear()
+{
+    postings_.clear();
+    entries_ = 0;
+    indexedFrom_ = 0;
+}
+
+quint32 LogIndex::trigram(const char* p)
+{
+    return static_cast<quint8>(foldAscii(p[0])) << 16 | static_cast<quint8>(foldAscii(p[1])) << 8 |
+           static_cast<quint8>(foldAscii(p[2]));
+}
+
+void LogIndex::addLine(int line, const QByteArray& utf8)
+{
+    const int block = line / BLOCK_LINES;
+    const char* data = utf8.constData();
+    for (int i = 0; i + 3 <= utf8.size(); ++i) {
+        // 行号只增不减，倒排表天然有序，末尾相同即说明本块已登记
+        QVector<int>& list = postings_[trigram(data + i)];
+        if (list.isEmpty() || list.last() != block) {
+            list.append(block);
+            ++entries_;
+        }
+    }
+}
+
+void LogIndex::dropBefore(int line)
+{
+    const int block = line / BLOCK_LINES;
+    if (block <= indexedFrom_) {
+        return;
+    }
+    indexedFrom_ = block;
+
+    // 倒排表按行块升序，去掉开头的一段即可
+    entries_ = 0;
+    for (auto it = postings_.begin(); it != postings_.end();) {
+        QVector<int>& list = it.value();
+        int keep = static_cast<int>(std::lower_bound(list.begin(), list.end(), block) - list.begin());
+        if (keep == list.size()) {
+            it = postings_.erase(it);
+            continue;
+        }
+        if (keep > 0) {
+            list.remove(0, keep);
+            list.squeeze();
+        }
+        entries_ += list.size();
+        ++it;
+    }
+}
+
+qint64 LogIndex::memorySize() const
+{
+    return entries_ * static_cast<qint64>(sizeof(int)) + postings_.size() * 32;
+}
+
+QList<QByteArray> LogIndex::requiredLiterals(const Query& query)
+{
+    QList<QByteArray> literals;
+    if (!query.regex) {
+        literals.append(query.text.toUtf8());
+    } else {
+        // 从正则表达式中提取必然出现的字面量：只取顶层、不受量词修饰的连续普通字符，
+        // 分组、字符类和转义类一律跳过；无法确定时返回空表，退化为全量扫描
+        const QString& p = query.text;
+        QString run;
+        int depth = 0;
+        auto flush = [&]() {
+            if (depth == 0 && !run.isEmpty()) {
+                literals.append(run.toUtf8());
+            }
+            run.clear();
+        };
+
+        for (int i = 0; i < p.size(); ++i) {
+            QChar c = p.at(i);
+            if (c == '\\') {
+                if (i + 1 >= p.size()) {
+                    break;
+                }
+                QChar next = p.at(i + 1);
+                if (next == 'Q') {
+                    return QList<QByteArray>();
+                }
+                if (next.isLetterOrNumber()) {
+                    // \d、\x41、\p{L} 之类：连同后面的字母数字一起跳过
+                    flush();
+                    ++i;
+                    while (i + 1 < p.size() && p.at(i + 1).isLetterOrNumber()) {
+                        ++i;
+                    }
+                    continue;
+                }
+                if (depth == 0) {
+                    run.append(next);
+                }
+                ++i;
+            } else if (c == '|') {
+                if (depth == 0) {
+                    return QList<QByteArray>();
+                }
+            } else if (c == '*' || c == '?' || c == '{') {
+                // 量词使前一个字符可有可无
+                run.chop(1);
+                flush();
+                if (c == '{') {
+                    while (i + 1 < p.size() && p.at(i) != '}') {
+                        ++i;
+                    }
+                }
+            } else if (c == '+' || c == '.' || c == '^' || c == '$') {
+                flush();
+            } else if (c == '[') {
+                flush();
+                ++i;
+                if (i < p.size() && p.at(i) == '^') {
+                    ++i;
+                }
+                if (i < p.size() && p.at(i) == ']') {
+                    ++i;
+                }
+                while (i < p.size() && p.at(i) != ']') {
+                    i += p.at(i) == '\\' ? 2 : 1;
+                }
+            } else if (c == '(') {
+                // (?i)、(?x) 等内联选项会改变后续字面量的含义
+                if (i + 2 < p.size() && p.at(i + 1) == '?' && (p.at(i + 2).isLetter() || p.at(i + 2) == '^')) {
+                    return QList<QByteArray>();
+                }
+                flush();
+                ++depth;
+            } else if (c == ')') {
+                flush();
+                depth = qMax(0, depth - 1);
+            } else if (depth == 0) {
+                run.append(c);
+            }
+        }
+        flush();
+    }
+
+    if (!query.regex && query.caseSensitive) {
+        return literals;
+    }
+
+    // 索引只折叠 ASCII 大小写，不区分大小写时非 ASCII 字符不能参与预筛选
+    QList<QByteArray> out;
+    for (const QByteArray& literal : literals) {
+        int start = 0;
+        for (int i = 0; i <= literal.size(); ++i) {
+            if (i == literal.size() || static_cast<quint8>(literal.at(i)) >= 0x80) {
+                if (i - start >= 3) {
+                    out.append(literal.mid(start, i - start));
+                }
+                start = i + 1;
+            }
+        }
+    }
+    return out;
+}
+
+QVector<int> LogIndex::candidateBlocks(const QList<QByteArray>& literals, int firstBlock, int lastBlock, bool& all) const
+{
+    QList<const QVector<int>*> lists;
+    for (const QByteArray& literal : literals) {
+        for (int i = 0; i + 3 <= literal.size(); ++i) {
+            auto it = postings_.constFind(trigram(literal.constData() + i));
+            if (it == postings_.constEnd()) {
+                all = false;
+                return QVector<int>();
+            }
+            lists.append(&it.value());
+        }
+    }
+
+    all = lists.isEmpty();
+    if (all) {
+        return QVector<int>();
+    }
+
+    // 从最短的倒排表开始求交集
+    std::sort(lists.begin(), lists.end(),
+              [](const QVector<int>* a, const QVector<int>* b) { return a->size() < b->size(); });
+
+    const QVector<int>& shortest = *lists.first();
+    auto begin = std::lower_bound(shortest.begin(), shortest.end(), firstBlock);
+    auto end = std::upper_bound(begin, shortest.end(), lastBlock);
+    QVector<int> result(begin, end);
+
+    for (int i = 1; i < lists.size() && !result.isEmpty(); ++i) {
+        const QVector<int>& list = *lists.at(i);
+        QVector<int> merged;
+        auto it = std::lower_bound(list.begin(), list.end(), result.first());
+        for (int block : result) {
+            it = std::lower_bound(it, list.end(), block);
+            if (it == list.end()) {
+                break;
+            }
+            if (*it == block) {
+                merged.append(block);
+            }
+        }
+        result.swap(merged);
+    }
+    return result;
+}
+
+bool LogIndex::search(const LogStore& store, const Query& query, int from, int to, QVector<int>& out) const
+{
+    to = qMin(to, store.lineCount());
+    from = qMax(0, from);
+    if (query.text.isEmpty() || from >= to) {
+        return true;
+    }
+
+    QRegularExpression re;
+    if (query.regex) {
+        re.setPattern(query.text);
+        re.setPatternOptions(query.caseSensitive ? QRegularExpression::NoPatternOption
+                                                 : QRegularExpression::CaseInsensitiveOption);
+        if (!re.isValid()) {
+            return false;
+        }
+    }
+    const QByteArray needle = query.text.toUtf8();
+    const Qt::CaseSensitivity cs = query.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+
+    auto matches = [&](int line) {
+        if (query.regex) {
+            return re.match(store.text(line)).hasMatch();
+        }
+        if (query.caseSensitive) {
+            return store.rawText(line).contains(needle);
+        }
+        return store.text(line).contains(query.text, cs);
+    };
+
+    // 倒排表已丢弃的旧行逐行扫描
+    const int indexedLine = qMin(to, indexedFrom_ * BLOCK_LINES);
+    for (int line = from; line < indexedLine; ++line) {
+        if (matches(line)) {
+            out.append(line);
+        }
+    }
+    from = qMax(from, indexedLine);
+    if (from >= to) {
+        return true;
+    }
+
+    bool all = false;
+    QVector<int> blocks = candidateBlocks(requiredLiterals(query), from / BLOCK_LINES, (to - 1) / BLOCK_LINES, all);
+    if (all) {
+        for (int line = from; line < to; ++line) {
+            if (matches(line)) {
+                out.append(line);
+            }
+        }
+        return true;
+    }
+
+    for (int block : blocks) {
+        int first = qMax(from, block * BLOCK_LINES);
+        int last = qMin(to, (block + 1) * BLOCK_LINES);
+        for (int line = first; line < last; ++line) {
+            if (matches(line)) {
+                out.append(line);
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+class LogStore;
+
+// 日志全文索引：追加行时把 UTF-8 内容（ASCII 字母折叠为小写）的三字节组登记到所在行块的倒排表，
+// 查询时先求所有必需三字节组的行块交集，再逐行校验。
+// 以行块而不是行为粒度，是为了让索引大小和日志本身在同一量级。
+// 索引计入 LogStore 的内存上限，超限时丢弃最旧行块的倒排表，这些行的查找退化为逐行扫描。
+class LogIndex
+{
+public:
+    struct Query {
+        QString text;
+        bool regex{};
+        bool caseSensitive{};
+    };
+
+public:
+    void clear();
+    void addLine(int line, const QByteArray& utf8);
+    // 丢弃只含 line 之前各行的行块的倒排表
+    void dropBefore(int line);
+    qint64 memorySize() const;
+
+    // 在 [from, to) 范围内查找匹配行，结果按行号升序追加到 out；
+    // 返回 false 表示查询无效（如正则表达式错误）
+    bool search(const LogStore& store, const Query& query, int from, int to, QVector<int>& out) const;
+    // 匹配行必然包含的字面量（UTF-8），用于按三字节组预筛选；返回空表表示无法预筛选
+    static QList<QByteArray> requiredLiterals(const Query& query);
+
+private:
+    static quint32 trigram(const char* p);
+    QVector<int> candidateBlocks(const QList<QByteArray>& literals, int firstBlock, int lastBlock, bool& all) const;
+
+private:
+    QHash<quint32, QVector<int>> postings_;
+    qint64 entries_{};
+    int indexedFrom_{};   // 第一个仍有倒排表的行块
+};
+
+#endif
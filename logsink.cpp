@@ -0,0 +1,44 @@
+#include "logsink.h"
+
+#include "logview.h"
+
+LogSink::LogSink(LogView* target, QObject* parent) : QObject(parent), target_(target)
+{
+    timer_.setInterval(16);
+    timer_.setSingleShot(true);
+    connect(&timer_, &QTimer::timeout, this, &LogSink::flush);
+}
+
+int LogSink::append(const QString& text, bool isError, qint64 time, const QVector<StyleRun>& styles)
+{
+    if (text.isEmpty()) {
+        return -1;
+    }
+    // 未指定时间时以追加时刻为准，进程输出使用 I/O 线程读取时的时间
+    if (time == 0) {
+        time = LogStore::tick();
+    }
+    int line = target_->store()->append(text, time, isError ? LogStore::FlagError : 0, styles);
+
+    if (!timer_.isActive()) {
+        timer_.start();
+    }
+    return line;
+}
+
+void LogSink::clear()
+{
+    timer_.stop();
+    target_->clear();
+}
+
+void LogSink::flush()
+{
+    timer_.stop();
+    target_->linesAppended();
+}
+
+void LogSink::setInterval(int ms)
+{
+    timer_.setInterval(ms);
+}
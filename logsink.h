@@ -0,0 +1,31 @@
+#ifndef LOGSINK_H
+#define LOGSINK_H
+
+#include <QObject>
+#include <QTimer>
+
+#include "ansidecoder.h"
+
+class LogView;
+
+// 日志批量输出：行直接追加到 LogStore，视图按帧（默认 16ms）刷新一次，
+// 避免每行一次排版、重绘和滚动条移动。
+class LogSink : public QObject
+{
+    Q_OBJECT
+
+public:
+    LogSink(LogView* target, QObject* parent = nullptr);
+
+public:
+    int append(const QString& text, bool isError = false, qint64 time = 0, const QVector<StyleRun>& styles = QVector<StyleRun>());
+    void clear();
+    void flush();
+    void setInterval(int ms);
+
+private:
+    LogView* target_{};
+    QTimer timer_;
+};
+
+#endif
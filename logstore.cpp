@@ -0,0 +1,319 @@
+#include "logstore.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QTemporaryFile>
+#include <algorithm>
+#include <chrono>
+
+// 每个块的容量，单行超过该大小时独占一个块
+constexpr int CHUNK_SIZE = 1 << 20;
+// 换入内存的非常驻块最多缓存的数量
+constexpr int CACHE_CHUNKS = 4;
+
+LogStore::LogStore()
+{
+    startTick_ = tick();
+    startWall_ = QDateTime::currentMSecsSinceEpoch();
+}
+
+LogStore::~LogStore()
+{
+    delete spill_;
+}
+
+void LogStore::setMemoryLimit(qint64 bytes)
+{
+    limit_ = bytes;
+    enforceLimit();
+}
+
+void LogStore::setSpillDir(const QString& dir)
+{
+    spillDir_ = dir;
+}
+
+qint64 LogStore::tick()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+qint64 LogStore::startTick() const
+{
+    return startTick_;
+}
+
+qint64 LogStore::startWallTime() const
+{
+    return startWall_;
+}
+
+int LogStore::append(const QString& text, qint64 time, quint8 flags, const QVector<StyleRun>& styles)
+{
+    QByteArray bytes = text.toUtf8();
+
+    if (chunks_.isEmpty() || chunks_.last().data.size() + bytes.size() > CHUNK_SIZE) {
+        Chunk chunk;
+        chunk.firstLine = lineCount_;
+        chunk.data.reserve(qMax(CHUNK_SIZE, bytes.size()));
+        chunks_.append(chunk);
+        // 上一个块已写满，检查是否需要压缩或转存
+        enforceLimit();
+    }
+
+    Chunk& chunk = chunks_.last();
+    chunk.offsets.append(static_cast<quint32>(chunk.data.size()));
+    chunk.data.append(bytes);
+    chunk.times.append(time);
+    chunk.flags.append(flags);
+    chunk.styleOffsets.append(static_cast<quint32>(chunk.styles.size()));
+    for (const StyleRun& run : styles) {
+        chunk.styles.append(static_cast<quint32>(run.start));
+        chunk.styles.append(run.style);
+    }
+    ++chunk.lineCount;
+    index_.addLine(lineCount_, bytes);
+
+    bytes_ += bytes.size();
+    memory_ += bytes.size() + sizeof(quint32) * 2 + sizeof(qint64) + sizeof(quint8) + styles.size() * sizeof(quint32) * 2;
+
+    return lineCount_++;
+}
+
+void LogStore::clear()
+{
+    chunks_.clear();
+    cache_.clear();
+    lineCount_ = 0;
+    bytes_ = 0;
+    memory_ = 0;
+    index_.clear();
+    delete spill_;
+    spill_ = nullptr;
+
+    // 清空即开始新一轮运行，重新记录时间基准
+    startTick_ = tick();
+    startWall_ = QDateTime::currentMSecsSinceEpoch();
+}
+
+int LogStore::lineCount() const
+{
+    return lineCount_;
+}
+
+int LogStore::chunkOf(int line) const
+{
+    // 找到最后一个 firstLine <= line 的块
+    auto it = std::upper_bound(chunks_.begin(), chunks_.end(), line,
+                               [](int l, const Chunk& c) { return l < c.firstLine; });
+    return static_cast<int>(it - chunks_.begin()) - 1;
+}
+
+const LogStore::Chunk& LogStore::load(int index) const
+{
+    const Chunk& meta = chunks_.at(index);
+    if (meta.state == Resident) {
+        return meta;
+    }
+
+    for (int i = 0; i < cache_.size(); ++i) {
+        if (cache_.at(i).firstLine == meta.firstLine) {
+            if (i != 0) {
+                cache_.move(i, 0);
+            }
+            return cache_.first();
+        }
+    }
+
+    QByteArray packed = meta.packed;
+    if (meta.state == Spilled && spill_) {
+        spill_->seek(meta.spillOffset);
+        packed = spill_->read(meta.spillSize);
+    }
+
+    Chunk chunk;
+    unpack(packed, chunk);
+    chunk.firstLine = meta.firstLine;
+    chunk.lineCount = meta.lineCount;
+
+    cache_.prepend(chunk);
+    while (cache_.size() > CACHE_CHUNKS) {
+        cache_.removeLast();
+    }
+    return cache_.first();
+}
+
+QByteArray LogStore::rawText(int line) const
+{
+    if (line < 0 || line >= lineCount_) {
+        return QByteArray();
+    }
+
+    const Chunk& chunk = load(chunkOf(line));
+    int local = line - chunk.firstLine;
+    if (local >= chunk.offsets.size()) {
+        // 换入失败（转存文件不可读），按空行处理
+        return QByteArray();
+    }
+
+    int begin = static_cast<int>(chunk.offsets.at(local));
+    int end = local + 1 < chunk.offsets.size() ? static_cast<int>(chunk.offsets.at(local + 1)) : chunk.data.size();
+    return QByteArray::fromRawData(chunk.data.constData() + begin, end - begin);
+}
+
+QString LogStore::text(int line) const
+{
+    QByteArray raw = rawText(line);
+    return QString::fromUtf8(raw.constData(), raw.size());
+}
+
+qint64 LogStore::time(int line) const
+{
+    if (line < 0 || line >= lineCount_) {
+        return 0;
+    }
+    const Chunk& chunk = load(chunkOf(line));
+    return chunk.times.value(line - chunk.firstLine);
+}
+
+quint8 LogStore::flags(int line) const
+{
+    if (line < 0 || line >= lineCount_) {
+        return 0;
+    }
+    const Chunk& chunk = load(chunkOf(line));
+    return chunk.flags.value(line - chunk.firstLine);
+}
+
+QVector<StyleRun> LogStore::styles(int line) const
+{
+    QVector<StyleRun> runs;
+    if (line < 0 || line >= lineCount_) {
+        return runs;
+    }
+    const Chunk& chunk = load(chunkOf(line));
+    int local = line - chunk.firstLine;
+    if (local >= chunk.styleOffsets.size()) {
+        return runs;
+    }
+    int begin = static_cast<int>(chunk.styleOffsets.at(local));
+    int end = local + 1 < chunk.styleOffsets.size() ? static_cast<int>(chunk.styleOffsets.at(local + 1)) : chunk.styles.size();
+    for (int i = begin; i + 1 < end; i += 2) {
+        runs.append({static_cast<int>(chunk.styles.at(i)), chunk.styles.at(i + 1)});
+    }
+    return runs;
+}
+
+qint64 LogStore::byteSize() const
+{
+    return bytes_;
+}
+
+qint64 LogStore::memorySize() const
+{
+    return memory_ + index_.memorySize();
+}
+
+bool LogStore::search(const LogIndex::Query& query, int from, int to, QVector<int>& out) const
+{
+    return index_.search(*this, query, from, to, out);
+}
+
+void LogStore::enforceLimit()
+{
+    if (limit_ <= 0) {
+        return;
+    }
+
+    // 最后一个块仍在写入，始终保持常驻；先压缩最旧的常驻块，压缩后仍超限再转存到文件，
+    // 最后丢弃已不常驻的块的索引
+    int last = chunks_.size() - 1;
+    int next = 0;
+    while (memorySize() > limit_ && next < last) {
+        Chunk& chunk = chunks_[next];
+        if (chunk.state != Resident) {
+            ++next;
+            continue;
+        }
+        qint64 before = residentBytes(chunk);
+        chunk.packed = qCompress(pack(chunk));
+        chunk.data = QByteArray();
+        chunk.offsets = QVector<quint32>();
+        chunk.times = QVector<qint64>();
+        chunk.flags = QVector<quint8>();
+        chunk.styleOffsets = QVector<quint32>();
+        chunk.styles = QVector<quint32>();
+        chunk.state = Compressed;
+        memory_ += chunk.packed.size() - before;
+        ++next;
+    }
+
+    next = 0;
+    while (memorySize() > limit_ && next < last && openSpill()) {
+        Chunk& chunk = chunks_[next];
+        if (chunk.state != Compressed) {
+            ++next;
+            continue;
+        }
+        qint64 offset = spill_->size();
+        spill_->seek(offset);
+        if (spill_->write(chunk.packed) != chunk.packed.size()) {
+            break;
+        }
+        chunk.spillOffset = offset;
+        chunk.spillSize = chunk.packed.size();
+        memory_ -= chunk.packed.size();
+        chunk.packed = QByteArray();
+        chunk.state = Spilled;
+        ++next;
+    }
+
+    if (last >= 0 && memorySize() > limit_) {
+        int resident = 0;
+        while (resident < last && chunks_.at(resident).state != Resident) {
+            ++resident;
+        }
+        index_.dropBefore(chunks_.at(resident).firstLine);
+    }
+}
+
+bool LogStore::openSpill()
+{
+    if (spill_) {
+        return true;
+    }
+    if (spillDir_.isEmpty()) {
+        return false;
+    }
+
+    // 临时文件随本次运行的日志一起删除
+    QTemporaryFile* file = new QTemporaryFile(spillDir_ + "/log-XXXXXX.spill");
+    if (!file->open()) {
+        delete file;
+        return false;
+    }
+    spill_ = file;
+    return true;
+}
+
+qint64 LogStore::residentBytes(const Chunk& chunk)
+{
+    return chunk.data.size() + chunk.offsets.size() * static_cast<qint64>(sizeof(quint32)) +
+           chunk.times.size() * static_cast<qint64>(sizeof(qint64)) + chunk.flags.size() * static_cast<qint64>(sizeof(quint8)) +
+           (chunk.styleOffsets.size() + chunk.styles.size()) * static_cast<qint64>(sizeof(quint32));
+}
+
+QByteArray LogStore::pack(const Chunk& chunk)
+{
+    QByteArray out;
+    QDataStream stream(&out, QIODevice::WriteOnly);
+    stream << chunk.data << chunk.offsets << chunk.times << chunk.flags << chunk.styleOffsets << chunk.styles;
+    return out;
+}
+
+void LogStore::unpack(const QByteArray& packed, Chunk& chunk)
+{
+    QByteArray raw = qUncompress(packed);
+    QDataStream stream(raw);
+    stream >> chunk.data >> chunk.offsets >> chunk.times >> chunk.flags >> chunk.styleOffsets >> chunk.styles;
+}
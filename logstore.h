@@ -0,0 +1,100 @@
+#ifndef LOGSTORE_H
+#define LOGSTORE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "ansidecoder.h"
+#include "logindex.h"
+
+class QFile;
+
+// 只追加的日志行存储：行内容按 UTF-8 连续写入固定大小的块，
+// 每个块自带行偏移索引，避免每行一个 QString 对象的开销。
+// 超出内存上限时，较旧的块先压缩，再转存到本次运行的临时日志文件，
+// 访问时按需换入。全文索引同样计入上限。
+class LogStore
+{
+public:
+    enum LineFlag : quint8 {
+        FlagError = 0x01,
+    };
+
+public:
+    LogStore();
+    ~LogStore();
+
+public:
+    void setMemoryLimit(qint64 bytes);
+    void setSpillDir(const QString& dir);
+
+    // 单调时钟（纳秒），可在任意线程调用，行时间戳统一用它记录
+    static qint64 tick();
+
+    int append(const QString& text, qint64 time, quint8 flags = 0, const QVector<StyleRun>& styles = QVector<StyleRun>());
+    void clear();
+
+    qint64 startTick() const;
+    qint64 startWallTime() const;
+
+    int lineCount() const;
+    QString text(int line) const;
+    // 返回的数据只在下一次访问存储前有效
+    QByteArray rawText(int line) const;
+    qint64 time(int line) const;
+    quint8 flags(int line) const;
+    QVector<StyleRun> styles(int line) const;
+    qint64 byteSize() const;
+    qint64 memorySize() const;
+
+    // 基于全文索引查找 [from, to) 范围内的匹配行
+    bool search(const LogIndex::Query& query, int from, int to, QVector<int>& out) const;
+
+private:
+    enum ChunkState {
+        Resident,
+        Compressed,
+        Spilled,
+    };
+
+    struct Chunk {
+        QByteArray data;
+        QVector<quint32> offsets;
+        QVector<qint64> times;
+        QVector<quint8> flags;
+        // 样式段按 (start, style) 成对展开存放，styleOffsets 为每行在 styles 中的起点
+        QVector<quint32> styleOffsets;
+        QVector<quint32> styles;
+        int firstLine{};
+        int lineCount{};
+        ChunkState state{Resident};
+        QByteArray packed;
+        qint64 spillOffset{};
+        int spillSize{};
+    };
+
+    int chunkOf(int line) const;
+    const Chunk& load(int index) const;
+    void enforceLimit();
+    bool openSpill();
+    static qint64 residentBytes(const Chunk& chunk);
+    static QByteArray pack(const Chunk& chunk);
+    static void unpack(const QByteArray& packed, Chunk& chunk);
+
+private:
+    QVector<Chunk> chunks_;
+    int lineCount_{};
+    qint64 bytes_{};
+    qint64 memory_{};
+    qint64 limit_{};
+    qint64 startTick_{};
+    qint64 startWall_{};
+    QString spillDir_;
+    QFile* spill_{};
+    LogIndex index_;
+    mutable QList<Chunk> cache_;
+};
+
+#endif
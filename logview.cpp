@@ -0,0 +1,435 @@
+#include "logview.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QDateTime>
+#include <QFile>
+#include <QFileDialog>
+#include <QKeyEvent>
+#include <QMenu>
+#include <QMessageBox>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+
+// 文本左边距
+constexpr int TEXT_MARGIN = 4;
+// 距上一行超过该间隔（毫秒）时高亮时间戳，便于发现构建停顿
+constexpr qint64 STALL_MS = 2000;
+
+static QString formatDuration(qint64 ms)
+{
+    qint64 h = ms / 3600000;
+    qint64 m = ms / 60000 % 60;
+    qint64 sec = ms / 1000 % 60;
+    qint64 z = ms % 1000;
+    if (h > 0) {
+        return QString::asprintf("%lld:%02lld:%02lld.%03lld", h, m, sec, z);
+    }
+    return QString::asprintf("%02lld:%02lld.%03lld", m, sec, z);
+}
+
+// ANSI 256 色调色板；前 16 色按浅色背景调暗，保证可读
+static QColor ansiColor(int index)
+{
+    static const QRgb base[16] = {
+        qRgb(0, 0, 0),       qRgb(205, 49, 49),   qRgb(0, 135, 0),     qRgb(175, 135, 0),
+        qRgb(4, 81, 165),    qRgb(188, 5, 188),   qRgb(5, 152, 188),   qRgb(160, 160, 160),
+        qRgb(102, 102, 102), qRgb(230, 60, 60),   qRgb(20, 160, 20),   qRgb(190, 150, 0),
+        qRgb(40, 110, 220),  qRgb(210, 60, 210),  qRgb(20, 170, 200),  qRgb(120, 120, 120),
+    };
+    if (index < 16) {
+        return QColor(base[index]);
+    }
+    if (index < 232) {
+        static const int levels[6] = {0, 95, 135, 175, 215, 255};
+        int i = index - 16;
+        return QColor(levels[i / 36], levels[i / 6 % 6], levels[i % 6]);
+    }
+    int gray = 8 + (index - 232) * 10;
+    return QColor(gray, gray, gray);
+}
+
+LogView::LogView(QWidget* parent) : QAbstractScrollArea(parent)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    verticalScrollBar()->setSingleStep(1);
+    horizontalScrollBar()->setSingleStep(20);
+    updateScrollRange();
+}
+
+LogStore* LogView::store()
+{
+    return &store_;
+}
+
+void LogView::linesAppended()
+{
+    // 处于底部时跟随新内容，否则保持用户当前的查看位置
+    QScrollBar* vScrollBar = verticalScrollBar();
+    bool follow = vScrollBar->value() >= vScrollBar->maximum();
+    updateScrollRange();
+    if (follow) {
+        vScrollBar->setValue(vScrollBar->maximum());
+    }
+    viewport()->update();
+}
+
+void LogView::clear()
+{
+    store_.clear();
+    maxWidth_ = 0;
+    selStart_ = -1;
+    selEnd_ = -1;
+    highlight_ = -1;
+    updateScrollRange();
+    viewport()->update();
+}
+
+void LogView::scrollToLine(int line)
+{
+    if (line < 0 || line >= store_.lineCount()) {
+        return;
+    }
+    highlight_ = line;
+    verticalScrollBar()->setValue(qMax(0, line - visibleRows() / 2));
+    viewport()->update();
+}
+
+void LogView::copySelection()
+{
+    if (selStart_ < 0) {
+        return;
+    }
+    int first = qMin(selStart_, selEnd_);
+    int last = qMax(selStart_, selEnd_);
+
+    QString text;
+    for (int i = first; i <= last && i < store_.lineCount(); ++i) {
+        text += timePrefix(i) + store_.text(i) + "\n";
+    }
+    QApplication::clipboard()->setText(text);
+}
+
+void LogView::selectAll()
+{
+    if (store_.lineCount() == 0) {
+        return;
+    }
+    selStart_ = 0;
+    selEnd_ = store_.lineCount() - 1;
+    viewport()->update();
+}
+
+void LogView::addContextAction(QAction* action)
+{
+    extraActions_.append(action);
+}
+
+void LogView::setTimeMode(TimeMode mode)
+{
+    timeMode_ = mode;
+    maxWidth_ = 0;
+    updateScrollRange();
+    viewport()->update();
+}
+
+LogView::TimeMode LogView::timeMode() const
+{
+    return timeMode_;
+}
+
+bool LogView::exportTo(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    // 时间戳只在导出时按当前显示方式格式化
+    for (int i = 0; i < store_.lineCount(); ++i) {
+        QByteArray line = timePrefix(i).toUtf8();
+        line.append(store_.rawText(i));
+        line.append('\n');
+        if (file.write(line) != line.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LogView::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(viewport());
+    painter.fillRect(viewport()->rect(), palette().color(QPalette::Base));
+
+    const QFontMetrics fm = fontMetrics();
+    const int lh = lineHeight();
+    const int first = verticalScrollBar()->value();
+    const int rows = visibleRows() + 1;
+    const int xOff = TEXT_MARGIN - horizontalScrollBar()->value();
+    const int selFirst = qMin(selStart_, selEnd_);
+    const int selLast = qMax(selStart_, selEnd_);
+    bool widthChanged = false;
+
+    for (int r = 0; r < rows; ++r) {
+        int line = first + r;
+        if (line >= store_.lineCount()) {
+            break;
+        }
+        int y = r * lh;
+        bool selected = selStart_ >= 0 && line >= selFirst && line <= selLast;
+
+        if (selected) {
+            painter.fillRect(0, y, viewport()->width(), lh, palette().color(QPalette::Highlight));
+        } else if (line == highlight_) {
+            painter.fillRect(0, y, viewport()->width(), lh, QColor(255, 245, 180));
+        }
+
+        QString prefix = timePrefix(line);
+        QString text = store_.text(line);
+
+        int x = xOff;
+        QColor timeColor(128, 128, 128);   // 灰色时间戳
+        if (timeMode_ != TimeWall && deltaMs(line) >= STALL_MS) {
+            timeColor = QColor(220, 90, 0);   // 停顿较长的行
+        }
+        painter.setPen(selected ? palette().color(QPalette::HighlightedText) : timeColor);
+        painter.drawText(x, y + fm.ascent(), prefix);
+        x += fm.horizontalAdvance(prefix);
+
+        if (selected) {
+            painter.setPen(palette().color(QPalette::HighlightedText));
+            painter.drawText(x, y + fm.ascent(), text);
+            x += fm.horizontalAdvance(text);
+        } else {
+            x = drawStyled(painter, x, y, text, store_.styles(line));
+        }
+
+        int width = x - xOff + TEXT_MARGIN;
+        if (width > maxWidth_) {
+            maxWidth_ = width;
+            widthChanged = true;
+        }
+    }
+
+    if (widthChanged) {
+        updateScrollRange();
+    }
+}
+
+int LogView::drawStyled(QPainter& painter, int x, int y, const QString& text, const QVector<StyleRun>& runs)
+{
+    const QColor normal(0, 0, 0);   // 黑色普通信息
+    const int lh = lineHeight();
+    if (runs.isEmpty()) {
+        painter.setPen(normal);
+        painter.drawText(x, y + fontMetrics().ascent(), text);
+        return x + fontMetrics().horizontalAdvance(text);
+    }
+
+    // 样式只在绘制时应用，逐段切换字体和颜色
+    int pos = 0;
+    int next = 0;
+    quint32 style = 0;
+    while (pos < text.size()) {
+        while (next < runs.size() && runs.at(next).start <= pos) {
+            style = runs.at(next).style;
+            ++next;
+        }
+        int end = next < runs.size() ? qMin(runs.at(next).start, text.size()) : text.size();
+        QString part = text.mid(pos, end - pos);
+
+        QFont font = this->font();
+        font.setBold(style & AnsiStyle::Bold);
+        font.setItalic(style & AnsiStyle::Italic);
+        font.setUnderline(style & AnsiStyle::Underline);
+        QFontMetrics fm(font);
+
+        QColor fg = (style & AnsiStyle::HasFg) ? ansiColor(style & AnsiStyle::FgMask) : normal;
+        QColor bg = (style & AnsiStyle::HasBg) ? ansiColor((style & AnsiStyle::BgMask) >> AnsiStyle::BgShift) : QColor();
+        if (style & AnsiStyle::Inverse) {
+            QColor back = bg.isValid() ? bg : palette().color(QPalette::Base);
+            bg = fg;
+            fg = back;
+        }
+        if (style & AnsiStyle::Faint) {
+            fg.setAlpha(140);
+        }
+
+        int width = fm.horizontalAdvance(part);
+        if (bg.isValid()) {
+            painter.fillRect(x, y, width, lh, bg);
+        }
+        painter.setFont(font);
+        painter.setPen(fg);
+        painter.drawText(x, y + fm.ascent(), part);
+        x += width;
+        pos = end;
+    }
+    painter.setFont(font());
+    return x;
+}
+
+void LogView::resizeEvent(QResizeEvent* event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollRange();
+}
+
+void LogView::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() != Qt::LeftButton || store_.lineCount() == 0) {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+    int line = lineAt(event->pos().y());
+    if ((event->modifiers() & Qt::ShiftModifier) && selStart_ >= 0) {
+        selEnd_ = line;
+    } else {
+        selStart_ = line;
+        selEnd_ = line;
+    }
+    viewport()->update();
+}
+
+void LogView::mouseMoveEvent(QMouseEvent* event)
+{
+    if (!(event->buttons() & Qt::LeftButton) || selStart_ < 0) {
+        QAbstractScrollArea::mouseMoveEvent(event);
+        return;
+    }
+
+    // 拖动到视图边缘时自动滚动
+    int y = event->pos().y();
+    if (y < 0) {
+        verticalScrollBar()->setValue(verticalScrollBar()->value() - 1);
+    } else if (y > viewport()->height()) {
+        verticalScrollBar()->setValue(verticalScrollBar()->value() + 1);
+    }
+    selEnd_ = lineAt(y);
+    viewport()->update();
+}
+
+void LogView::keyPressEvent(QKeyEvent* event)
+{
+    if (event->matches(QKeySequence::Copy)) {
+        copySelection();
+        return;
+    }
+    if (event->matches(QKeySequence::SelectAll)) {
+        selectAll();
+        return;
+    }
+    if (event->matches(QKeySequence::MoveToStartOfDocument)) {
+        verticalScrollBar()->setValue(0);
+        return;
+    }
+    if (event->matches(QKeySequence::MoveToEndOfDocument)) {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+        return;
+    }
+    QAbstractScrollArea::keyPressEvent(event);
+}
+
+void LogView::contextMenuEvent(QContextMenuEvent* event)
+{
+    QMenu menu(this);
+
+    QAction* copyAction = menu.addAction("复制");
+    QAction* selectAllAction = menu.addAction("全选");
+
+    copyAction->setEnabled(selStart_ >= 0);
+
+    menu.addSeparator();
+    QMenu* timeMenu = menu.addMenu("时间显示");
+    QAction* wallAction = timeMenu->addAction("时钟时间");
+    QAction* elapsedAction = timeMenu->addAction("运行时长");
+    QAction* deltaAction = timeMenu->addAction("距上一行");
+    wallAction->setCheckable(true);
+    elapsedAction->setCheckable(true);
+    deltaAction->setCheckable(true);
+    wallAction->setChecked(timeMode_ == TimeWall);
+    elapsedAction->setChecked(timeMode_ == TimeElapsed);
+    deltaAction->setChecked(timeMode_ == TimeDelta);
+    QAction* exportAction = menu.addAction("导出日志...");
+    exportAction->setEnabled(store_.lineCount() > 0);
+
+    if (!extraActions_.isEmpty()) {
+        menu.addSeparator();
+        menu.addActions(extraActions_);
+    }
+
+    QAction* selectedAction = menu.exec(event->globalPos());
+
+    if (selectedAction == copyAction) {
+        copySelection();
+    } else if (selectedAction == selectAllAction) {
+        selectAll();
+    } else if (selectedAction == wallAction) {
+        setTimeMode(TimeWall);
+    } else if (selectedAction == elapsedAction) {
+        setTimeMode(TimeElapsed);
+    } else if (selectedAction == deltaAction) {
+        setTimeMode(TimeDelta);
+    } else if (selectedAction == exportAction) {
+        QString path = QFileDialog::getSaveFileName(this, "导出日志", QString(), "日志文件 (*.log *.txt);;所有文件 (*.*)");
+        if (!path.isEmpty() && !exportTo(path)) {
+            QMessageBox::warning(this, "错误", "导出日志失败：\n" + path);
+        }
+    }
+}
+
+void LogView::updateScrollRange()
+{
+    int rows = qMax(1, viewport()->height() / lineHeight());
+    QScrollBar* vScrollBar = verticalScrollBar();
+    vScrollBar->setPageStep(rows);
+    vScrollBar->setRange(0, qMax(0, store_.lineCount() - rows));
+
+    QScrollBar* hScrollBar = horizontalScrollBar();
+    hScrollBar->setPageStep(viewport()->width());
+    hScrollBar->setRange(0, qMax(0, maxWidth_ - viewport()->width()));
+}
+
+int LogView::lineHeight() const
+{
+    return qMax(1, fontMetrics().height());
+}
+
+int LogView::visibleRows() const
+{
+    return viewport()->height() / lineHeight();
+}
+
+int LogView::lineAt(int y) const
+{
+    int line = verticalScrollBar()->value() + qMax(0, y) / lineHeight();
+    return qBound(0, line, qMax(0, store_.lineCount() - 1));
+}
+
+QString LogView::timePrefix(int line) const
+{
+    switch (timeMode_) {
+    case TimeElapsed:
+        return "[+" + formatDuration((store_.time(line) - store_.startTick()) / 1000000) + "] ";
+    case TimeDelta: {
+        qint64 ms = deltaMs(line);
+        return QString::asprintf("[+%6lld.%03lld] ", ms / 1000, ms % 1000);
+    }
+    default: {
+        qint64 ms = store_.startWallTime() + (store_.time(line) - store_.startTick()) / 1000000;
+        return "[" + QDateTime::fromMSecsSinceEpoch(ms).toString("hh:mm:ss.zzz") + "] ";
+    }
+    }
+}
+
+qint64 LogView::deltaMs(int line) const
+{
+    qint64 prev = line > 0 ? store_.time(line - 1) : store_.startTick();
+    return qMax<qint64>(0, (store_.time(line) - prev) / 1000000);
+}
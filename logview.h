@@ -0,0 +1,65 @@
+#ifndef LOGVIEW_H
+#define LOGVIEW_H
+
+#include <QAbstractScrollArea>
+
+#include "logstore.h"
+
+class QAction;
+class QPainter;
+
+// 基于 LogStore 的日志视图，只绘制可见行，行数增长不影响重绘开销。
+class LogView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    enum TimeMode {
+        TimeWall,      // 墙上时间
+        TimeElapsed,   // 距本次运行开始
+        TimeDelta,     // 距上一行
+    };
+
+public:
+    LogView(QWidget* parent = nullptr);
+
+public:
+    LogStore* store();
+    void linesAppended();
+    void clear();
+    void scrollToLine(int line);
+    void copySelection();
+    void selectAll();
+    void addContextAction(QAction* action);
+    void setTimeMode(TimeMode mode);
+    TimeMode timeMode() const;
+    bool exportTo(const QString& path);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+    void contextMenuEvent(QContextMenuEvent* event) override;
+
+private:
+    void updateScrollRange();
+    int lineHeight() const;
+    int visibleRows() const;
+    int lineAt(int y) const;
+    QString timePrefix(int line) const;
+    qint64 deltaMs(int line) const;
+    int drawStyled(QPainter& painter, int x, int y, const QString& text, const QVector<StyleRun>& runs);
+
+private:
+    LogStore store_;
+    int maxWidth_{};
+    int selStart_{-1};
+    int selEnd_{-1};
+    int highlight_{-1};
+    QList<QAction*> extraActions_;
+    TimeMode timeMode_{TimeWall};
+};
+
+#endif
@@ -1,9 +1,14 @@
 #include <QApplication>
 
 #include "cmakebuilder.h"
+#include "headless.h"
 
 int main(int argc, char* argv[])
 {
+    if (Headless::requested(argc, argv)) {
+        return Headless::run(argc, argv);
+    }
+
     QApplication a(argc, argv);
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
@@ -0,0 +1,349 @@
+#include "ninjalog.h"
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <algorithm>
+
+namespace {
+
+struct LogEntry {
+    qint64 start{};
+    qint64 end{};
+    QString output;
+    QByteArray hash;
+};
+
+// build.ninja 中的一条 build 语句
+struct Statement {
+    QString rule;
+    QStringList inputs;
+};
+
+struct Graph {
+    QVector<Statement> stmts;
+    QHash<QString, int> producer;   // 输出 -> 语句
+};
+
+QString normalize(const QString& path)
+{
+    return QDir::cleanPath(path);
+}
+
+// 读取本次构建写入的记录。ninja 每次启动时间从 0 开始，没有可用的偏移时结束时间回退即为新一次构建
+bool readLog(const QString& logFile, qint64 offset, QVector<LogEntry>& entries, QString& error)
+{
+    QFile file(logFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = "未找到 .ninja_log";
+        return false;
+    }
+    QByteArray header = file.readLine().trimmed();
+    if (!header.startsWith("# ninja log v") || header.mid(13).toInt() < 5) {
+        error = "不支持的 .ninja_log 格式: " + QString::fromUtf8(header);
+        return false;
+    }
+    // 日志被 ninja 整理重写后偏移不再落在行首，此时只能从头按时间回退识别
+    qint64 body = file.pos();
+    // 偏移为 0 表示构建前还没有日志，整个文件都属于本次构建
+    bool fromOffset = offset == 0;
+    if (offset > body && offset <= file.size()) {
+        char prev = 0;
+        file.seek(offset - 1);
+        fromOffset = file.getChar(&prev) && prev == '\n';
+        if (!fromOffset) {
+            file.seek(body);
+        }
+    }
+
+    qint64 lastEnd = -1;
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        QList<QByteArray> fields = line.split('\t');
+        if (fields.size() < 5) {
+            continue;
+        }
+        LogEntry e;
+        e.start = fields.at(0).toLongLong();
+        e.end = fields.at(1).toLongLong();
+        e.output = normalize(QString::fromUtf8(fields.at(3)));
+        e.hash = fields.at(4);
+        // 从本次构建的偏移读起时，时间回退只可能是 ninja 重新生成 build.ninja 后在同一次构建中重启，
+        // 之前的记录同样属于本次构建，重复的输出由调用方按最后一次去重；
+        // 没有可用的偏移时只能把时间回退视为新一次构建的开始
+        if (e.end < lastEnd && !fromOffset) {
+            entries.clear();
+        }
+        lastEnd = e.end;
+        entries.append(e);
+    }
+    return true;
+}
+
+// 按 ninja 的转义规则切分 build 语句：$ 空格、$:、$$ 为字面字符，未转义的 : 单独成词
+QStringList tokenize(const QByteArray& text)
+{
+    QStringList tokens;
+    QByteArray token;
+    auto flush = [&]() {
+        if (!token.isEmpty()) {
+            tokens << QString::fromUtf8(token);
+            token.clear();
+        }
+    };
+    for (int i = 0; i < text.size(); ++i) {
+        char c = text.at(i);
+        if (c == '$' && i + 1 < text.size()) {
+            char n = text.at(++i);
+            if (n != ' ' && n != ':' && n != '$') {
+                token += '$';
+            }
+            token += n;
+        } else if (c == ' ') {
+            flush();
+        } else if (c == ':') {
+            flush();
+            tokens << ":";
+        } else {
+            token += c;
+        }
+    }
+    flush();
+    return tokens;
+}
+
+void addStatement(const QByteArray& text, Graph& graph)
+{
+    QStringList tokens = tokenize(text);
+    int colon = tokens.indexOf(":");
+    if (colon <= 0 || colon + 1 >= tokens.size()) {
+        return;
+    }
+
+    Statement stmt;
+    stmt.rule = tokens.at(colon + 1);
+    for (int i = colon + 2; i < tokens.size(); ++i) {
+        const QString& t = tokens.at(i);
+        if (t == "|@") {
+            break;
+        }
+        if (t != "|" && t != "||") {
+            stmt.inputs << normalize(t);
+        }
+    }
+
+    int index = graph.stmts.size();
+    graph.stmts.append(stmt);
+    for (int i = 0; i < colon; ++i) {
+        if (tokens.at(i) != "|") {
+            graph.producer.insert(normalize(tokens.at(i)), index);
+        }
+    }
+}
+
+// 只关心 build、include 和 subninja，多配置生成器的语句分布在被包含的文件中
+void parseManifest(const QString& buildTree, const QString& ninjaFile, Graph& graph, int depth = 0)
+{
+    QFile file(ninjaFile);
+    if (depth > 8 || !file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QByteArray stmt;
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        while (line.endsWith('\n') || line.endsWith('\r')) {
+            line.chop(1);
+        }
+        int dollars = 0;
+        while (dollars < line.size() && line.at(line.size() - 1 - dollars) == '$') {
+            ++dollars;
+        }
+        if (dollars % 2 == 1) {
+            line.chop(1);
+            stmt += stmt.isEmpty() ? line : line.trimmed();
+            continue;
+        }
+        stmt += stmt.isEmpty() ? line : line.trimmed();
+
+        if (stmt.startsWith("build ")) {
+            addStatement(stmt.mid(6), graph);
+        } else if (stmt.startsWith("include ") || stmt.startsWith("subninja ")) {
+            QString path = QString::fromUtf8(stmt.mid(stmt.indexOf(' ') + 1).trimmed());
+            parseManifest(buildTree, QDir(buildTree).absoluteFilePath(path), graph, depth + 1);
+        }
+        stmt.clear();
+    }
+}
+
+NinjaEdge::Kind classify(const NinjaEdge& edge)
+{
+    // CMake 的规则名形如 CXX_COMPILER__app_Debug、CXX_EXECUTABLE_LINKER__app_Debug
+    if (edge.rule.contains("LINKER")) {
+        return NinjaEdge::Link;
+    }
+    if (edge.rule.contains("COMPILER")) {
+        return NinjaEdge::Compile;
+    }
+    if (!edge.rule.isEmpty()) {
+        return NinjaEdge::Other;
+    }
+    const QString& out = edge.outputs.first();
+    if (out.endsWith(".o") || out.endsWith(".obj")) {
+        return NinjaEdge::Compile;
+    }
+    static const char* linked[] = {".exe", ".dll", ".so", ".dylib", ".a", ".lib"};
+    for (const char* ext : linked) {
+        if (out.endsWith(ext) || out.contains(QString(ext) + ".")) {
+            return NinjaEdge::Link;
+        }
+    }
+    return NinjaEdge::Other;
+}
+
+// 依赖图上以语句为终点的最长耗时链，未执行的语句耗时为 0
+struct PathSearch {
+    const Graph& graph;
+    const QVector<qint64>& cost;
+    QVector<qint64> memo;
+    QVector<int> prev;
+
+    PathSearch(const Graph& g, const QVector<qint64>& c)
+        : graph(g), cost(c), memo(g.stmts.size(), -1), prev(g.stmts.size(), -1)
+    {
+    }
+
+    qint64 visit(int s)
+    {
+        if (memo[s] >= 0) {
+            return memo[s];
+        }
+        memo[s] = 0;
+        qint64 best = 0;
+        for (const QString& input : graph.stmts[s].inputs) {
+            int p = graph.producer.value(input, -1);
+            if (p < 0) {
+                continue;
+            }
+            qint64 v = visit(p);
+            if (v > best) {
+                best = v;
+                prev[s] = p;
+            }
+        }
+        memo[s] = best + cost[s];
+        return memo[s];
+    }
+};
+
+QVector<int> slowest(const QVector<NinjaEdge>& edges, NinjaEdge::Kind kind, int top)
+{
+    QVector<int> result;
+    for (int i = 0; i < edges.size(); ++i) {
+        if (edges[i].kind == kind) {
+            result << i;
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [&edges](int a, int b) { return edges[a].duration() > edges[b].duration(); });
+    if (result.size() > top) {
+        result.resize(top);
+    }
+    return result;
+}
+
+}   // namespace
+
+namespace NinjaLog {
+
+BuildReport analyze(const QString& buildTree, const QString& ninjaFile, qint64 logOffset, int top)
+{
+    BuildReport report;
+    QVector<LogEntry> entries;
+    if (!readLog(buildTree + "/.ninja_log", logOffset, entries, report.error)) {
+        return report;
+    }
+    report.valid = true;
+
+    // 同一命令的多个输出记录为多行，开始、结束时间和命令哈希相同；
+    // ninja 中途重新生成 build.ninja 后重启时，同一输出以最后一次为准
+    QHash<QString, int> byOutput;
+    QHash<QString, int> byCommand;
+    for (const LogEntry& e : entries) {
+        QString key = QString("%1:%2:%3").arg(e.start).arg(e.end).arg(QString::fromLatin1(e.hash));
+        int index = byCommand.value(key, -1);
+        if (index < 0) {
+            index = report.edges.size();
+            byCommand.insert(key, index);
+            NinjaEdge edge;
+            edge.start = e.start;
+            edge.end = e.end;
+            report.edges.append(edge);
+        }
+        int old = byOutput.value(e.output, -1);
+        if (old >= 0 && old != index) {
+            report.edges[old].outputs.removeAll(e.output);
+        }
+        byOutput.insert(e.output, index);
+        report.edges[index].outputs << e.output;
+    }
+    report.edges.erase(std::remove_if(report.edges.begin(), report.edges.end(),
+                                      [](const NinjaEdge& edge) { return edge.outputs.isEmpty(); }),
+                       report.edges.end());
+    std::sort(report.edges.begin(), report.edges.end(),
+              [](const NinjaEdge& a, const NinjaEdge& b) { return a.start < b.start || (a.start == b.start && a.end < b.end); });
+    if (report.edges.isEmpty()) {
+        return report;
+    }
+
+    Graph graph;
+    parseManifest(buildTree, ninjaFile, graph);
+
+    QVector<qint64> cost(graph.stmts.size(), 0);
+    QHash<int, int> edgeOf;   // 语句 -> edges 下标
+    qint64 first = report.edges.first().start;
+    for (int i = 0; i < report.edges.size(); ++i) {
+        NinjaEdge& edge = report.edges[i];
+        for (const QString& out : edge.outputs) {
+            int s = graph.producer.value(out, -1);
+            if (s >= 0) {
+                edge.rule = graph.stmts[s].rule;
+                cost[s] = qMax(cost[s], edge.duration());
+                edgeOf.insert(s, i);
+                break;
+            }
+        }
+        edge.kind = classify(edge);
+        first = qMin(first, edge.start);
+        report.wallMs = qMax(report.wallMs, edge.end);
+        report.cpuMs += edge.duration();
+    }
+    report.wallMs -= first;
+    report.parallelism = report.wallMs > 0 ? static_cast<double>(report.cpuMs) / report.wallMs : 0;
+    report.slowestCompile = slowest(report.edges, NinjaEdge::Compile, top);
+    report.slowestLink = slowest(report.edges, NinjaEdge::Link, top);
+
+    if (edgeOf.isEmpty()) {
+        return report;
+    }
+    PathSearch search(graph, cost);
+    int last = -1;
+    for (auto it = edgeOf.constBegin(); it != edgeOf.constEnd(); ++it) {
+        if (last < 0 || search.visit(it.key()) > search.visit(last)) {
+            last = it.key();
+        }
+    }
+    report.criticalMs = search.visit(last);
+    for (int s = last; s >= 0; s = search.prev[s]) {
+        auto it = edgeOf.constFind(s);
+        if (it != edgeOf.constEnd()) {
+            report.criticalPath.prepend(it.value());
+        }
+    }
+    return report;
+}
+
+}   // namespace NinjaLog
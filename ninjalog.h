@@ -0,0 +1,52 @@
+#ifndef NINJALOG_H
+#define NINJALOG_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// .ninja_log 中的一条边（同一命令的多个输出合为一条），时间为毫秒，相对本次构建开始
+struct NinjaEdge {
+    enum Kind {
+        Compile,
+        Link,
+        Other,
+    };
+
+    QStringList outputs;
+    qint64 start{};
+    qint64 end{};
+    QString rule;
+    Kind kind{Other};
+
+    qint64 duration() const
+    {
+        return end - start;
+    }
+};
+
+// 一次构建的耗时分析
+struct BuildReport {
+    bool valid{};
+    QString error;
+    QVector<NinjaEdge> edges;   // 本次构建实际执行的边，按开始时间排序
+    qint64 wallMs{};
+    qint64 cpuMs{};
+    double parallelism{};
+    // 依赖图上耗时最长的一条链（edges 的下标，按执行顺序），没有 build.ninja 时为空
+    QVector<int> criticalPath;
+    qint64 criticalMs{};
+    QVector<int> slowestCompile;
+    QVector<int> slowestLink;
+};
+
+// 构建结束后分析 .ninja_log：取出本次构建执行的边，结合 build.ninja 的依赖图
+// 计算关键路径、最慢的编译和链接、CPU 时间与并行度。build.ninja 较大时耗时明显，应在线程池中调用。
+namespace NinjaLog {
+
+// logOffset 为构建开始前 .ninja_log 的大小（没有日志时为 0）；日志被 ninja 重写而变小时，按时间回退识别最后一次构建
+BuildReport analyze(const QString& buildTree, const QString& ninjaFile, qint64 logOffset, int top = 10);
+
+}   // namespace NinjaLog
+
+#endif
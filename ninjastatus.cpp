@@ -0,0 +1,40 @@
+#include "ninjastatus.h"
+
+#include <QStringList>
+
+constexpr auto STATUS_BEGIN = "@@nst ";
+constexpr auto STATUS_END = "@@";
+
+bool parseNinjaStatus(const QString& line, NinjaProgress& progress, QString* description)
+{
+    if (!line.startsWith(QLatin1String(STATUS_BEGIN))) {
+        return false;
+    }
+
+    int begin = static_cast<int>(qstrlen(STATUS_BEGIN));
+    int end = line.indexOf(QLatin1String(STATUS_END), begin);
+    if (end < 0) {
+        return false;
+    }
+
+    QStringList fields = line.mid(begin, end - begin).split(' ');
+    if (fields.size() != 4) {
+        return false;
+    }
+
+    bool ok[4] = {};
+    NinjaProgress p;
+    p.finished = fields[0].toInt(&ok[0]);
+    p.total = fields[1].toInt(&ok[1]);
+    p.running = fields[2].toInt(&ok[2]);
+    p.elapsed = fields[3].toDouble(&ok[3]);
+    if (!ok[0] || !ok[1] || !ok[2] || !ok[3]) {
+        return false;
+    }
+
+    progress = p;
+    if (description) {
+        *description = line.mid(end + static_cast<int>(qstrlen(STATUS_END))).trimmed();
+    }
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef NINJASTATUS_H
+#define NINJASTATUS_H
+
+#include <QString>
+
+// 构建时设置给 ninja 的状态行格式：已完成/总数/运行中/已用秒数，前缀用于识别
+constexpr auto NINJA_STATUS_FORMAT = "@@nst %f %t %r %e@@ ";
+
+struct NinjaProgress {
+    int finished{};
+    int total{};
+    int running{};
+    double elapsed{};
+};
+
+// 解析一行 ninja 状态输出，成功时返回 true 并给出进度和边的描述
+bool parseNinjaStatus(const QString& line, NinjaProgress& progress, QString* description = nullptr);
+
+#endif
@@ -0,0 +1,142 @@
+#include "outputfilter.h"
+
+#include <QDir>
+
+void OutputFilter::reset()
+{
+    groups_.clear();
+    unit_.clear();
+    prelude_.clear();
+    dropping_ = false;
+}
+
+bool OutputFilter::feed(const OutputLine& line, QVector<OutputLine>& out, NinjaProgress& progress)
+{
+    const QString& text = line.text;
+    QString description;
+    if (!line.isError && parseNinjaStatus(text, progress, &description)) {
+        // ninja 在边结束时输出状态行，紧随其后的是该边的输出
+        flushPrelude(out);
+        dropping_ = false;
+        unit_ = unitFromDescription(description);
+        return true;
+    }
+
+    // 结构化诊断（JSON/SARIF）不直接显示原文，按文本格式逐条展开
+    QVector<Diagnostic> diags;
+    if (parser_.parseStructured(text, diags)) {
+        for (const Diagnostic& diag : diags) {
+            OutputLine expanded;
+            expanded.text = DiagnosticParser::format(diag);
+            expanded.time = line.time;
+            expanded.isError = line.isError;
+            emitDiagnostic(diag, expanded, out);
+        }
+        return false;
+    }
+
+    Diagnostic diag;
+    if (parser_.parseLine(text, diag)) {
+        emitDiagnostic(diag, line, out);
+        return false;
+    }
+
+    // 包含链等前导行属于下一条诊断，先暂存，等确定该诊断是否重复
+    if (isPrelude(text)) {
+        dropping_ = false;
+        prelude_.append(line);
+        return false;
+    }
+    if (dropping_ && isContext(text)) {
+        return false;
+    }
+    dropping_ = false;
+    flushPrelude(out);
+    out.append(line);
+    return false;
+}
+
+void OutputFilter::finish(QVector<OutputLine>& out)
+{
+    flushPrelude(out);
+}
+
+void OutputFilter::emitDiagnostic(Diagnostic diag, OutputLine line, QVector<OutputLine>& out)
+{
+    // note 跟随所属的诊断，所属诊断被折叠时一起折叠
+    if (diag.severity == Diagnostic::Note) {
+        if (dropping_) {
+            return;
+        }
+        flushPrelude(out);
+        line.diag = diag;
+        out.append(line);
+        return;
+    }
+
+    diag.unit = unit_;
+    QString key = QDir::cleanPath(diag.file) + '\n' + QString::number(diag.line) + '\n' + diag.message;
+    auto it = groups_.constFind(key);
+    if (it == groups_.constEnd()) {
+        diag.group = groups_.size();
+        groups_.insert(key, diag.group);
+        dropping_ = false;
+        flushPrelude(out);
+        line.diag = diag;
+        out.append(line);
+        return;
+    }
+
+    diag.group = it.value();
+    prelude_.clear();
+    dropping_ = true;
+    line.diag = diag;
+    line.hidden = true;
+    out.append(line);
+}
+
+void OutputFilter::flushPrelude(QVector<OutputLine>& out)
+{
+    if (prelude_.isEmpty()) {
+        return;
+    }
+    out += prelude_;
+    prelude_.clear();
+}
+
+bool OutputFilter::isPrelude(const QString& text)
+{
+    if (text.startsWith(QLatin1String("In file included from "))) {
+        return true;
+    }
+    if (text.startsWith(' ') && text.trimmed().startsWith(QLatin1String("from "))) {
+        return true;
+    }
+    // GCC 的 "foo.h: In function 'f':"、"foo.h: In instantiation of ...:" 等上下文行
+    if (text.endsWith(':') && (text.contains(QLatin1String(": In ")) || text.contains(QLatin1String(": At ")))) {
+        return true;
+    }
+    return text.contains(QLatin1String("required from"));
+}
+
+bool OutputFilter::isContext(const QString& text)
+{
+    // 源码片段、^ 标记和续行都以空白开头
+    return text.startsWith(' ') || text.startsWith('\t');
+}
+
+QString OutputFilter::unitFromDescription(const QString& description)
+{
+    // "Building CXX object CMakeFiles/app.dir/src/main.cpp.o" -> "src/main.cpp"
+    QString unit = description.section(' ', -1);
+    int dir = unit.indexOf(QLatin1String(".dir/"));
+    if (dir >= 0) {
+        unit = unit.mid(dir + 5);
+    }
+    if (unit.endsWith(QLatin1String(".obj"))) {
+        unit.chop(4);
+    } else if (unit.endsWith(QLatin1String(".o"))) {
+        unit.chop(2);
+    }
+    return unit;
+}
@@ -0,0 +1,47 @@
+#ifndef OUTPUTFILTER_H
+#define OUTPUTFILTER_H
+
+#include <QHash>
+#include <QVector>
+
+#include "ansidecoder.h"
+#include "diagnostics.h"
+#include "ninjastatus.h"
+
+struct OutputLine {
+    QString text;
+    qint64 time{};
+    bool isError{};
+    bool hidden{};     // 被折叠的重复诊断，只计数不写入日志
+    Diagnostic diag;   // 该行识别出的编译器诊断，severity 为 None 表示普通行
+    QVector<StyleRun> styles;
+};
+
+// 进程输出的逐行处理流水线（在 I/O 线程中运行）：
+// 1. ninja 状态行折叠为进度，并记录当前编译单元；
+// 2. 识别编译器诊断，JSON/SARIF 展开为文本行；
+// 3. 按 (file, line, message) 去重，重复诊断连同其上下文（包含链、源码片段、note）从日志中折叠。
+class OutputFilter
+{
+public:
+    void reset();
+    // 返回 true 表示该行是 ninja 状态行，progress 已更新
+    bool feed(const OutputLine& line, QVector<OutputLine>& out, NinjaProgress& progress);
+    void finish(QVector<OutputLine>& out);
+
+private:
+    void emitDiagnostic(Diagnostic diag, OutputLine line, QVector<OutputLine>& out);
+    void flushPrelude(QVector<OutputLine>& out);
+    static bool isPrelude(const QString& text);
+    static bool isContext(const QString& text);
+    static QString unitFromDescription(const QString& description);
+
+private:
+    DiagnosticParser parser_;
+    QHash<QString, int> groups_;
+    QString unit_;
+    QVector<OutputLine> prelude_;
+    bool dropping_{};
+};
+
+#endif
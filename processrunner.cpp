@@ -0,0 +1,768 @@
+#include "processrunner.h"
+
+#include <QSet>
+#include <QSocketNotifier>
+#include <QTimer>
+#ifdef Q_OS_LINUX
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#endif
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#include "linesplitter.h"
+#include "logstore.h"
+#include "ptyprocess.h"
+#include "terminalrenderer.h"
+
+// 取消时 SIGINT 之后等待的时间，让 ninja 写完 .ninja_log/.ninja_deps（毫秒）
+constexpr int CANCEL_GRACE_MS = 5000;
+// SIGTERM 之后升级为 SIGKILL 前等待的时间（毫秒）
+constexpr int CANCEL_TERM_MS = 3000;
+// 主进程退出后检查进程组是否已清空的间隔（毫秒）
+constexpr int GROUP_POLL_MS = 50;
+// 伪终端子进程退出后继续读取的时间（毫秒）：转入后台的孙进程可能一直占着从端，等不到 EIO
+constexpr int PTY_DRAIN_MS = 100;
+
+#ifdef Q_OS_LINUX
+// 读取 /proc/<pid>/stat 中的父进程号和进程组号；进程名可能含空格和括号，从最后一个 ')' 之后解析
+static bool readProcStat(const QString& pid, qint64& ppid, qint64& pgid)
+{
+    QFile file("/proc/" + pid + "/stat");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray stat = file.readAll();
+    int end = stat.lastIndexOf(')');
+    if (end < 0) {
+        return false;
+    }
+    // 之后依次是 state ppid pgrp ...
+    QList<QByteArray> fields = stat.mid(end + 2).split(' ');
+    if (fields.size() < 3) {
+        return false;
+    }
+    ppid = fields.at(1).toLongLong();
+    pgid = fields.at(2).toLongLong();
+    return true;
+}
+#endif
+
+#if defined(Q_OS_UNIX) && QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+// Qt5 没有 setChildProcessModifier，通过 setupChildProcess 让子进程自成一个进程组
+class GroupProcess : public QProcess
+{
+public:
+    using QProcess::QProcess;
+
+protected:
+    void setupChildProcess() override
+    {
+        ::setpgid(0, 0);
+    }
+};
+#endif
+
+// I/O 线程中的实际执行者，只在该线程内访问 QProcess
+class ProcessWorker : public QObject
+{
+public:
+    enum CancelStage {
+        CancelInterrupt,   // SIGINT / CTRL_BREAK
+        CancelTerminate,   // SIGTERM
+        CancelKill,        // SIGKILL / taskkill /F
+    };
+
+public:
+    ProcessWorker(ProcessRunner* runner) : runner_(runner)
+    {
+        escalateTimer_ = new QTimer(this);
+        escalateTimer_->setSingleShot(true);
+        connect(escalateTimer_, &QTimer::timeout, this, [this]() { escalate(); });
+        groupTimer_ = new QTimer(this);
+        groupTimer_->setInterval(GROUP_POLL_MS);
+        connect(groupTimer_, &QTimer::timeout, this, [this]() { pollGroup(); });
+#ifdef Q_OS_LINUX
+        ptyExitTimer_ = new QTimer(this);
+        ptyExitTimer_->setInterval(GROUP_POLL_MS);
+        connect(ptyExitTimer_, &QTimer::timeout, this, [this]() { pollPty(); });
+        ptyDrainTimer_ = new QTimer(this);
+        ptyDrainTimer_->setSingleShot(true);
+        connect(ptyDrainTimer_, &QTimer::timeout, this, [this]() {
+            if (pty_) {
+                drainPty();
+            }
+            if (pty_) {
+                finishPty();
+            }
+        });
+#endif
+    }
+
+public:
+    void start(const QString& program, const QStringList& arguments, const QString& workDir,
+               const QProcessEnvironment& env, bool usePty);
+    void cancel();
+    void shutdown();
+
+private:
+    void drain();
+    void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onError(QProcess::ProcessError error);
+    void finishRun(int exitCode, QProcess::ExitStatus exitStatus);
+    void complete(int exitCode, QProcess::ExitStatus exitStatus);
+    qint64 childPid() const;
+    void escalate();
+    void signalGroup(CancelStage stage);
+    void trackDescendants();
+    bool groupAlive() const;
+    void pollGroup();
+#ifdef Q_OS_LINUX
+    void startPty(const QString& program, const QStringList& arguments, const QString& workDir,
+                  const QProcessEnvironment& env);
+    void drainPty();
+    void pollPty();
+    void finishPty();
+#endif
+
+private:
+    ProcessRunner* runner_{};
+    QProcess* process_{};
+    LineSplitter stdoutSplitter_;
+    LineSplitter stderrSplitter_;
+    AnsiDecoder stdoutAnsi_;
+    AnsiDecoder stderrAnsi_;
+#ifdef Q_OS_LINUX
+    PtyProcess* pty_{};
+    QSocketNotifier* ptyNotifier_{};
+    QTimer* ptyExitTimer_{};
+    QTimer* ptyDrainTimer_{};
+    TerminalRenderer terminal_;
+#endif
+    // 取消状态：子进程自成进程组，组号即子进程 pid
+    bool cancelling_{};
+    qint64 group_{};
+    // 后代进程及其所在的其他进程组：ninja 让每条命令自成进程组，只处理 group_ 会漏掉编译器和链接器
+    QSet<qint64> tracked_;
+    QSet<qint64> groups_;
+    CancelStage stage_{CancelInterrupt};
+    qint64 cancelTick_{};
+    QTimer* escalateTimer_{};
+    QTimer* groupTimer_{};
+    int pendingExitCode_{};
+    QProcess::ExitStatus pendingExitStatus_{QProcess::NormalExit};
+};
+
+void ProcessWorker::start(const QString& program, const QStringList& arguments, const QString& workDir,
+                          const QProcessEnvironment& env, bool usePty)
+{
+    // 每次运行使用独立的分行和过滤状态，避免上次未完成的行串到本次输出
+    stdoutSplitter_.reset();
+    stderrSplitter_.reset();
+    stdoutAnsi_.reset();
+    stderrAnsi_.reset();
+    runner_->filter_.reset();
+    cancelling_ = false;
+    escalateTimer_->stop();
+    groupTimer_->stop();
+
+#ifdef Q_OS_LINUX
+    if (usePty) {
+        startPty(program, arguments, workDir, env);
+        return;
+    }
+#else
+    Q_UNUSED(usePty);
+#endif
+
+    if (!process_) {
+#if defined(Q_OS_UNIX) && QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+        process_ = new GroupProcess(this);
+#else
+        process_ = new QProcess(this);
+#endif
+#if defined(Q_OS_UNIX) && QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        process_->setChildProcessModifier([]() { ::setpgid(0, 0); });
+#elif defined(Q_OS_WIN)
+        // 独立的控制台进程组才能单独收到 CTRL_BREAK
+        process_->setCreateProcessArgumentsModifier(
+            [](QProcess::CreateProcessArguments* args) { args->flags |= CREATE_NEW_PROCESS_GROUP; });
+#endif
+        connect(process_, &QProcess::readyReadStandardOutput, this, [this]() { drain(); });
+        connect(process_, &QProcess::readyReadStandardError, this, [this]() { drain(); });
+        connect(process_, &QProcess::started, this, [this]() {
+            runner_->startedTick_ = LogStore::tick();
+            emit runner_->sigStarted();
+        });
+        connect(process_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this](int exitCode, QProcess::ExitStatus exitStatus) { onFinished(exitCode, exitStatus); });
+        connect(process_, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) { onError(error); });
+    }
+
+    process_->setWorkingDirectory(workDir);
+    process_->setProcessEnvironment(env);
+    process_->start(program, arguments);
+}
+
+qint64 ProcessWorker::childPid() const
+{
+#ifdef Q_OS_LINUX
+    if (pty_) {
+        return pty_->pid();
+    }
+#endif
+    if (process_ && process_->state() != QProcess::NotRunning) {
+        return process_->processId();
+    }
+    return 0;
+}
+
+void ProcessWorker::cancel()
+{
+    if (cancelling_) {
+        // 再次取消时不再等待，直接升级到下一级
+        escalate();
+        return;
+    }
+    qint64 pid = childPid();
+    if (pid <= 0) {
+        return;
+    }
+
+    // 先发 SIGINT，ninja 收到后会等待正在运行的命令结束并保存构建日志和依赖
+    cancelling_ = true;
+    group_ = pid;
+    tracked_.clear();
+    groups_.clear();
+    trackDescendants();
+    stage_ = CancelInterrupt;
+    cancelTick_ = LogStore::tick();
+    signalGroup(CancelInterrupt);
+    if (stage_ < CancelKill) {
+        escalateTimer_->start(CANCEL_GRACE_MS);
+    }
+}
+
+void ProcessWorker::escalate()
+{
+    if (stage_ >= CancelKill) {
+        return;
+    }
+    stage_ = static_cast<CancelStage>(stage_ + 1);
+    // 父进程被杀后后代会被 init 收养，无法再从进程树找到，必须在发信号之前记下
+    trackDescendants();
+    signalGroup(stage_);
+    if (stage_ < CancelKill) {
+        escalateTimer_->start(CANCEL_TERM_MS);
+    }
+}
+
+void ProcessWorker::signalGroup(CancelStage stage)
+{
+#ifdef Q_OS_WIN
+    if (stage == CancelInterrupt) {
+        if (GenerateConsoleCtrlEvent(CTRL_BREAK_EVENT, static_cast<DWORD>(group_))) {
+            return;
+        }
+        // 没有共享控制台时无法发送 CTRL_BREAK，直接终止进程树。界面程序没有控制台，总是走到这里：
+        // Windows 上取消构建没有优雅阶段，ninja 来不及写入最后完成的边，下次构建时这些边会重新执行
+        stage_ = CancelKill;
+    }
+    QProcess::execute("taskkill", {"/T", "/F", "/PID", QString::number(group_)});
+#else
+    static const int sigs[] = {SIGINT, SIGTERM, SIGKILL};
+    if (::kill(-static_cast<pid_t>(group_), sigs[stage]) != 0 && errno == ESRCH) {
+        // 子进程还没来得及调用 setpgid，退回到只发给子进程本身
+        ::kill(static_cast<pid_t>(group_), sigs[stage]);
+    }
+    // SIGINT 由 ninja 转发给各条命令并等待它们结束；之后的阶段 ninja 可能已无法转发，直接发给各进程组
+    if (stage != CancelInterrupt) {
+        for (qint64 group : groups_) {
+            ::kill(-static_cast<pid_t>(group), sigs[stage]);
+        }
+    }
+#endif
+}
+
+void ProcessWorker::trackDescendants()
+{
+#ifdef Q_OS_LINUX
+    QMap<qint64, QPair<qint64, qint64>> procs;   // pid -> (ppid, pgid)
+    for (const QString& name : QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        bool ok = false;
+        qint64 pid = name.toLongLong(&ok);
+        qint64 ppid = 0;
+        qint64 pgid = 0;
+        if (ok && readProcStat(name, ppid, pgid)) {
+            procs.insert(pid, qMakePair(ppid, pgid));
+        }
+    }
+
+    // 已记录的进程可能在此期间派生了新进程，一并作为起点
+    QSet<qint64> known = tracked_;
+    known.insert(group_);
+    bool grown = true;
+    while (grown) {
+        grown = false;
+        for (auto it = procs.cbegin(); it != procs.cend(); ++it) {
+            if (!known.contains(it.key()) && known.contains(it.value().first)) {
+                known.insert(it.key());
+                grown = true;
+            }
+        }
+    }
+
+    // 已退出的进程号可能被复用，只保留仍然存在的
+    tracked_.clear();
+    qint64 own = ::getpgrp();
+    for (qint64 pid : known) {
+        auto it = procs.constFind(pid);
+        if (it == procs.cend() || pid == group_) {
+            continue;
+        }
+        tracked_.insert(pid);
+        if (it.value().second != group_ && it.value().second != own) {
+            groups_.insert(it.value().second);
+        }
+    }
+#endif
+    // 其他 Unix 系统没有 /proc 进程树，只能处理 group_，移入其他进程组的后代不在清理范围内
+}
+
+bool ProcessWorker::groupAlive() const
+{
+#ifdef Q_OS_WIN
+    // taskkill /T 已按进程树终止，Windows 上没有进程组可查
+    return false;
+#else
+    if (::kill(-static_cast<pid_t>(group_), 0) == 0 || errno == EPERM) {
+        return true;
+    }
+    for (qint64 group : groups_) {
+        if (::kill(-static_cast<pid_t>(group), 0) == 0 || errno == EPERM) {
+            return true;
+        }
+    }
+    return false;
+#endif
+}
+
+void ProcessWorker::pollGroup()
+{
+    // 升级到 SIGKILL 之后仍无法清空（如进程处于不可中断状态），不再等待
+    qint64 waited = (LogStore::tick() - cancelTick_) / 1000000;
+#ifndef Q_OS_WIN
+    // 已清空的进程组号可能被复用，不再跟踪；SIGKILL 之后收尾期间新出现的后代同样结束掉
+    for (auto it = groups_.begin(); it != groups_.end();) {
+        if (::kill(-static_cast<pid_t>(*it), 0) != 0 && errno == ESRCH) {
+            it = groups_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    trackDescendants();
+    if (stage_ == CancelKill) {
+        for (qint64 group : groups_) {
+            ::kill(-static_cast<pid_t>(group), SIGKILL);
+        }
+    }
+#endif
+    if (!groupAlive() || waited > CANCEL_GRACE_MS + CANCEL_TERM_MS * 2) {
+        groupTimer_->stop();
+        complete(pendingExitCode_, pendingExitStatus_);
+    }
+}
+
+void ProcessWorker::shutdown()
+{
+    escalateTimer_->stop();
+    groupTimer_->stop();
+#ifdef Q_OS_LINUX
+    ptyExitTimer_->stop();
+    ptyDrainTimer_->stop();
+#endif
+    qint64 pid = childPid();
+    if (pid > 0) {
+        // 程序退出时不再等待，直接结束整个进程组及各条命令所在的进程组
+        group_ = pid;
+        tracked_.clear();
+        groups_.clear();
+        trackDescendants();
+        signalGroup(CancelKill);
+    }
+#ifdef Q_OS_LINUX
+    delete ptyNotifier_;
+    ptyNotifier_ = nullptr;
+    delete pty_;   // 析构时终止并回收子进程
+    pty_ = nullptr;
+#endif
+    if (!process_) {
+        return;
+    }
+    if (process_->state() != QProcess::NotRunning) {
+        process_->kill();
+        process_->waitForFinished(3000);
+    }
+    delete process_;
+    process_ = nullptr;
+}
+
+void ProcessWorker::drain()
+{
+    qint64 now = LogStore::tick();
+    QStringList lines;
+
+    QByteArray outputData = process_->readAllStandardOutput();
+    QByteArray errorData = process_->readAllStandardError();
+    if (!outputData.isEmpty() || !errorData.isEmpty()) {
+        runner_->markOutput(now);
+    }
+
+    if (!outputData.isEmpty()) {
+        stdoutSplitter_.feed(outputData, lines);
+        runner_->push(lines, false, now, stdoutAnsi_);
+        lines.clear();
+    }
+
+    if (!errorData.isEmpty()) {
+        stderrSplitter_.feed(errorData, lines);
+        runner_->push(lines, true, now, stderrAnsi_);
+    }
+}
+
+void ProcessWorker::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    // 读取剩余的输出，进程结束时最后一行可能没有换行符
+    drain();
+    finishRun(exitCode, exitStatus);
+}
+
+void ProcessWorker::finishRun(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (cancelling_ && groupAlive()) {
+        // 主进程（cmake）先退出时，ninja 和编译器可能仍在收尾，等整个进程组退出后再结束本次运行
+        pendingExitCode_ = exitCode;
+        pendingExitStatus_ = exitStatus;
+        groupTimer_->start();
+        return;
+    }
+    complete(exitCode, exitStatus);
+}
+
+void ProcessWorker::complete(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (cancelling_) {
+        escalateTimer_->stop();
+        runner_->shutdownMs_ = (LogStore::tick() - cancelTick_) / 1000000;
+        runner_->shutdownStage_ = stage_;
+        runner_->shutdownLeftover_ = groupAlive();
+        cancelling_ = false;
+    }
+
+    qint64 now = LogStore::tick();
+    QStringList lines;
+    stdoutSplitter_.finish(lines);
+    runner_->push(lines, false, now, stdoutAnsi_);
+    lines.clear();
+    stderrSplitter_.finish(lines);
+    runner_->push(lines, true, now, stderrAnsi_);
+
+    QVector<OutputLine> rest;
+    runner_->filter_.finish(rest);
+    runner_->publish(rest);
+
+    runner_->running_ = false;
+    emit runner_->sigFinished(exitCode, exitStatus);
+}
+
+#ifdef Q_OS_LINUX
+void ProcessWorker::startPty(const QString& program, const QStringList& arguments, const QString& workDir,
+                            const QProcessEnvironment& env)
+{
+    terminal_.reset();
+    pty_ = new PtyProcess;
+    if (!pty_->start(program, arguments, workDir, env)) {
+        QStringList lines{pty_->errorString()};
+        runner_->push(lines, true, LogStore::tick(), stderrAnsi_);
+        delete pty_;
+        pty_ = nullptr;
+        runner_->running_ = false;
+        emit runner_->sigError(QProcess::FailedToStart);
+        return;
+    }
+
+    ptyNotifier_ = new QSocketNotifier(pty_->fd(), QSocketNotifier::Read, this);
+    connect(ptyNotifier_, &QSocketNotifier::activated, this, [this]() { drainPty(); });
+    ptyExitTimer_->start();
+    runner_->startedTick_ = LogStore::tick();
+    emit runner_->sigStarted();
+}
+
+void ProcessWorker::drainPty()
+{
+    qint64 now = LogStore::tick();
+    QByteArray cooked;
+    char buf[64 * 1024];
+    bool closed = false;
+    for (;;) {
+        qint64 n = pty_->read(buf, sizeof(buf));
+        if (n <= 0) {
+            closed = n < 0;
+            break;
+        }
+        runner_->markOutput(now);
+        terminal_.feed(QByteArray::fromRawData(buf, static_cast<int>(n)), cooked);
+    }
+
+    // 终端里 stdout 和 stderr 已合并，统一按 stdout 处理
+    if (!cooked.isEmpty()) {
+        QStringList lines;
+        stdoutSplitter_.feed(cooked, lines);
+        runner_->push(lines, false, now, stdoutAnsi_);
+    }
+    // ninja 的状态行原地刷新而不换行，直接从未完成的行更新进度
+    if (!terminal_.pending().isEmpty()) {
+        runner_->peekStatus(QString::fromUtf8(terminal_.pending()));
+    }
+
+    if (closed) {
+        finishPty();
+    }
+}
+
+void ProcessWorker::pollPty()
+{
+    // 子进程退出后只再读取一小段时间，之后即使从端仍被占用也视为输出结束
+    if (pty_->poll()) {
+        ptyExitTimer_->stop();
+        ptyDrainTimer_->start(PTY_DRAIN_MS);
+    }
+}
+
+void ProcessWorker::finishPty()
+{
+    ptyExitTimer_->stop();
+    ptyDrainTimer_->stop();
+    // 可能正处于该通知器的信号中，不能直接删除
+    ptyNotifier_->setEnabled(false);
+    ptyNotifier_->deleteLater();
+    ptyNotifier_ = nullptr;
+
+    QByteArray cooked;
+    terminal_.finish(cooked);
+    QStringList lines;
+    stdoutSplitter_.feed(cooked, lines);
+    runner_->push(lines, false, LogStore::tick(), stdoutAnsi_);
+
+    int exitCode = 0;
+    bool crashed = false;
+    pty_->wait(exitCode, crashed);
+    delete pty_;
+    pty_ = nullptr;
+
+    finishRun(exitCode, crashed ? QProcess::CrashExit : QProcess::NormalExit);
+}
+#endif
+
+void ProcessWorker::onError(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart) {
+        runner_->running_ = false;
+    }
+    emit runner_->sigError(error);
+}
+
+ProcessRunner::ProcessRunner(QObject* parent) : QObject(parent)
+{
+    qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
+    qRegisterMetaType<QProcess::ProcessError>("QProcess::ProcessError");
+
+    env_ = QProcessEnvironment::systemEnvironment();
+    worker_ = new ProcessWorker(this);
+    worker_->moveToThread(&thread_);
+    thread_.setObjectName("ProcessRunner");
+    thread_.start();
+}
+
+ProcessRunner::~ProcessRunner()
+{
+    ProcessWorker* worker = worker_;
+    QMetaObject::invokeMethod(worker_, [worker]() { worker->shutdown(); }, Qt::BlockingQueuedConnection);
+    thread_.quit();
+    thread_.wait();
+    delete worker_;
+}
+
+void ProcessRunner::setWorkingDirectory(const QString& dir)
+{
+    workDir_ = dir;
+}
+
+void ProcessRunner::setProcessEnvironment(const QProcessEnvironment& env)
+{
+    env_ = env;
+}
+
+QProcessEnvironment ProcessRunner::processEnvironment() const
+{
+    return env_;
+}
+
+void ProcessRunner::setUsePty(bool use)
+{
+    usePty_ = use;
+}
+
+bool ProcessRunner::usePty() const
+{
+    return usePty_;
+}
+
+void ProcessRunner::start(const QString& program, const QStringList& arguments)
+{
+    // 启动完全异步：结果由 sigStarted 或 sigError(FailedToStart) 通知
+    startTick_ = LogStore::tick();
+    startedTick_ = 0;
+    firstOutputTick_ = 0;
+    shutdownMs_ = -1;
+    shutdownStage_ = 0;
+    shutdownLeftover_ = false;
+    running_ = true;
+    finished_ = 0;
+    total_ = 0;
+    runningEdges_ = 0;
+    elapsedMs_ = 0;
+    ProcessWorker* worker = worker_;
+    QString workDir = workDir_;
+    QProcessEnvironment env = env_;
+    bool usePty = usePty_;
+    QMetaObject::invokeMethod(
+        worker_,
+        [worker, program, arguments, workDir, env, usePty]() { worker->start(program, arguments, workDir, env, usePty); },
+        Qt::QueuedConnection);
+}
+
+void ProcessRunner::cancel()
+{
+    ProcessWorker* worker = worker_;
+    QMetaObject::invokeMethod(worker_, [worker]() { worker->cancel(); }, Qt::QueuedConnection);
+}
+
+bool ProcessRunner::isRunning() const
+{
+    return running_;
+}
+
+int ProcessRunner::takeLines(QVector<OutputLine>& lines)
+{
+    // 先清除通知标记再取数据，取数据期间新到的行会再触发一次通知
+    notifyPending_ = false;
+
+    int count = 0;
+    OutputLine line;
+    while (queue_.pop(line)) {
+        lines.append(line);
+        ++count;
+    }
+    return count;
+}
+
+RunStats ProcessRunner::runStats() const
+{
+    RunStats stats;
+    qint64 start = startTick_;
+    qint64 started = startedTick_;
+    qint64 firstOutput = firstOutputTick_;
+    if (started > 0) {
+        stats.startMs = (started - start) / 1000000;
+    }
+    if (firstOutput > 0) {
+        stats.firstOutputMs = (firstOutput - start) / 1000000;
+    }
+    stats.shutdownMs = shutdownMs_;
+    stats.shutdownStage = shutdownStage_;
+    stats.shutdownLeftover = shutdownLeftover_;
+    return stats;
+}
+
+void ProcessRunner::markOutput(qint64 time)
+{
+    qint64 expected = 0;
+    firstOutputTick_.compare_exchange_strong(expected, time);
+}
+
+NinjaProgress ProcessRunner::takeProgress()
+{
+    progressPending_ = false;
+
+    NinjaProgress progress;
+    progress.finished = finished_;
+    progress.total = total_;
+    progress.running = runningEdges_;
+    progress.elapsed = elapsedMs_ / 1000.0;
+    return progress;
+}
+
+void ProcessRunner::push(const QStringList& lines, bool isError, qint64 time, AnsiDecoder& ansi)
+{
+    if (lines.isEmpty()) {
+        return;
+    }
+
+    QVector<OutputLine> out;
+    for (const QString& text : lines) {
+        // 先去掉颜色转义，后续的状态行和诊断识别只看纯文本
+        OutputLine line;
+        line.text = ansi.decode(text, line.styles);
+        line.time = time;
+        line.isError = isError;
+        if (line.text.isEmpty()) {
+            continue;
+        }
+
+        NinjaProgress progress;
+        if (filter_.feed(line, out, progress)) {
+            updateProgress(progress);
+        }
+    }
+    publish(out);
+}
+
+void ProcessRunner::peekStatus(const QString& text)
+{
+    NinjaProgress progress;
+    if (parseNinjaStatus(text, progress)) {
+        updateProgress(progress);
+    }
+}
+
+void ProcessRunner::updateProgress(const NinjaProgress& progress)
+{
+    finished_ = progress.finished;
+    total_ = progress.total;
+    runningEdges_ = progress.running;
+    elapsedMs_ = static_cast<qint64>(progress.elapsed * 1000);
+    if (!progressPending_.exchange(true)) {
+        emit sigProgress();
+    }
+}
+
+void ProcessRunner::publish(const QVector<OutputLine>& lines)
+{
+    if (lines.isEmpty()) {
+        return;
+    }
+    for (const OutputLine& line : lines) {
+        queue_.push(line);
+    }
+    if (!notifyPending_.exchange(true)) {
+        emit sigOutput();
+    }
+}
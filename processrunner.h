@@ -0,0 +1,93 @@
+#ifndef PROCESSRUNNER_H
+#define PROCESSRUNNER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+
+#include "outputfilter.h"
+#include "spscqueue.h"
+
+class ProcessWorker;
+
+// 一次运行的耗时统计（毫秒），-1 表示尚未发生
+struct RunStats {
+    qint64 startMs{-1};         // 从调用 start 到进程创建完成
+    qint64 firstOutputMs{-1};   // 从调用 start 到读到第一段输出
+    qint64 shutdownMs{-1};      // 从取消到整个进程树退出（或等待超时）
+    int shutdownStage{};        // 取消时最终用到的信号：0 SIGINT，1 SIGTERM，2 SIGKILL
+    bool shutdownLeftover{};    // 等待超时，仍有后代进程未退出
+};
+
+// 在独立 I/O 线程中运行子进程并持续读取管道，界面繁忙时子进程也不会因管道写满而阻塞。
+// 输出按行经无锁 SPSC 队列交给界面线程，sigOutput 在队列由空变为非空时发出一次。
+// ninja 状态行在 I/O 线程中解析并折叠为进度，sigProgress 同样合并发出；
+// 编译器诊断也在此识别并去重，随行一起交给界面线程建立索引。
+class ProcessRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    ProcessRunner(QObject* parent = nullptr);
+    ~ProcessRunner();
+
+public:
+    void setWorkingDirectory(const QString& dir);
+    void setProcessEnvironment(const QProcessEnvironment& env);
+    QProcessEnvironment processEnvironment() const;
+    // 在伪终端中运行（仅 Linux），ninja 等工具输出单行刷新的状态而不是每条边一行
+    void setUsePty(bool use);
+    bool usePty() const;
+    void start(const QString& program, const QStringList& arguments);
+    // 取消运行：向子进程所在的进程组发 SIGINT，超时后依次升级为 SIGTERM、SIGKILL，
+    // 整个进程组退出后才发出 sigFinished；再次调用立即升级到下一级
+    void cancel();
+    bool isRunning() const;
+    int takeLines(QVector<OutputLine>& lines);
+    NinjaProgress takeProgress();
+    RunStats runStats() const;
+
+Q_SIGNALS:
+    void sigOutput();
+    void sigProgress();
+    void sigStarted();
+    void sigFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void sigError(QProcess::ProcessError error);
+
+private:
+    friend class ProcessWorker;
+    void push(const QStringList& lines, bool isError, qint64 time, AnsiDecoder& ansi);
+    void publish(const QVector<OutputLine>& lines);
+    void markOutput(qint64 time);
+    void peekStatus(const QString& text);
+    void updateProgress(const NinjaProgress& progress);
+
+private:
+    QThread thread_;
+    ProcessWorker* worker_{};
+    QString workDir_;
+    QProcessEnvironment env_;
+    bool usePty_{};
+    SpscQueue<OutputLine> queue_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> notifyPending_{false};
+    // ninja 状态行不进入日志，只保留最新进度
+    std::atomic<int> finished_{0};
+    std::atomic<int> total_{0};
+    std::atomic<int> runningEdges_{0};
+    std::atomic<qint64> elapsedMs_{0};
+    std::atomic<bool> progressPending_{false};
+    // 启动耗时统计，单调时钟（纳秒）
+    std::atomic<qint64> startTick_{0};
+    std::atomic<qint64> startedTick_{0};
+    std::atomic<qint64> firstOutputTick_{0};
+    std::atomic<qint64> shutdownMs_{-1};
+    std::atomic<int> shutdownStage_{0};
+    std::atomic<bool> shutdownLeftover_{false};
+    // 仅在 I/O 线程中使用
+    OutputFilter filter_;
+};
+
+#endif
@@ -0,0 +1,228 @@
+#include "ptyprocess.h"
+
+#ifdef Q_OS_LINUX
+#include <QFile>
+#include <QStandardPaths>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// 终端列数取得足够宽，避免 ninja 按终端宽度截断状态行
+constexpr unsigned short PTY_COLUMNS = 512;
+constexpr unsigned short PTY_ROWS = 50;
+
+PtyProcess::~PtyProcess()
+{
+    if (pid_ > 0) {
+        kill();
+        int exitCode = 0;
+        bool crashed = false;
+        wait(exitCode, crashed);
+    }
+    if (master_ >= 0) {
+        ::close(master_);
+    }
+}
+
+int PtyProcess::fd() const
+{
+    return master_;
+}
+
+qint64 PtyProcess::pid() const
+{
+    return exited_ ? -1 : pid_;
+}
+
+QString PtyProcess::errorString() const
+{
+    return error_;
+}
+
+bool PtyProcess::start(const QString& program, const QStringList& arguments, const QString& workDir,
+                       const QProcessEnvironment& env)
+{
+    // fork 之后子进程只能调用异步信号安全的函数，所有参数在此之前准备好
+    QString path = program;
+    if (!program.contains('/')) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        QStringList dirs = env.value("PATH").split(':', Qt::SkipEmptyParts);
+#else
+        QStringList dirs = env.value("PATH").split(':', QString::SkipEmptyParts);
+#endif
+        path = QStandardPaths::findExecutable(program, dirs);
+    }
+    if (path.isEmpty()) {
+        error_ = "找不到可执行文件: " + program;
+        return false;
+    }
+
+    QProcessEnvironment childEnv = env;
+    if (childEnv.value("TERM").isEmpty() || childEnv.value("TERM") == "dumb") {
+        childEnv.insert("TERM", "xterm-256color");
+    }
+
+    QByteArray pathBytes = QFile::encodeName(path);
+    QByteArray dirBytes = QFile::encodeName(workDir);
+    QByteArray failMsg = "无法执行: " + pathBytes + "\n";
+
+    QList<QByteArray> argBytes;
+    argBytes << QFile::encodeName(program);
+    for (const QString& arg : arguments) {
+        argBytes << arg.toLocal8Bit();
+    }
+    std::vector<char*> argv;
+    for (QByteArray& arg : argBytes) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    QList<QByteArray> envBytes;
+    for (const QString& item : childEnv.toStringList()) {
+        envBytes << item.toLocal8Bit();
+    }
+    std::vector<char*> envp;
+    for (QByteArray& item : envBytes) {
+        envp.push_back(item.data());
+    }
+    envp.push_back(nullptr);
+
+    // 不用 forkpty：它创建的主端没有 O_CLOEXEC，补设之前其他线程 fork 出的进程（如队列任务）会继承主端，
+    // 从端因此迟迟不能全部关闭，读取方等不到 EIO
+    int master = ::posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master < 0) {
+        error_ = QString("创建伪终端失败: %1").arg(strerror(errno));
+        return false;
+    }
+    char slaveName[128] = {};
+    if (::grantpt(master) != 0 || ::unlockpt(master) != 0 || ::ptsname_r(master, slaveName, sizeof(slaveName)) != 0) {
+        error_ = QString("创建伪终端失败: %1").arg(strerror(errno));
+        ::close(master);
+        return false;
+    }
+    struct winsize ws {};
+    ws.ws_col = PTY_COLUMNS;
+    ws.ws_row = PTY_ROWS;
+    ::ioctl(master, TIOCSWINSZ, &ws);
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        error_ = QString("创建子进程失败: %1").arg(strerror(errno));
+        ::close(master);
+        return false;
+    }
+    if (pid == 0) {
+        // 新会话，打开的从端成为控制终端；进程组号即 pid，取消时按组发送信号
+        ::setsid();
+        int slave = ::open(slaveName, O_RDWR);
+        if (slave < 0) {
+            _exit(127);
+        }
+        ::ioctl(slave, TIOCSCTTY, 0);
+        ::dup2(slave, STDIN_FILENO);
+        ::dup2(slave, STDOUT_FILENO);
+        ::dup2(slave, STDERR_FILENO);
+        if (slave > STDERR_FILENO) {
+            ::close(slave);
+        }
+        if (!dirBytes.isEmpty() && ::chdir(dirBytes.constData()) != 0) {
+            _exit(127);
+        }
+        ::execve(pathBytes.constData(), argv.data(), envp.data());
+        ssize_t ignored = ::write(STDERR_FILENO, failMsg.constData(), failMsg.size());
+        (void)ignored;
+        _exit(127);
+    }
+
+    ::fcntl(master, F_SETFL, ::fcntl(master, F_GETFL) | O_NONBLOCK);
+    master_ = master;
+    pid_ = pid;
+    return true;
+}
+
+qint64 PtyProcess::read(char* buf, qint64 size)
+{
+    if (master_ < 0) {
+        return -1;
+    }
+    for (;;) {
+        ssize_t n = ::read(master_, buf, static_cast<size_t>(size));
+        if (n > 0) {
+            return n;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN) {
+            return 0;
+        }
+        // 从端全部关闭后 Linux 返回 EIO
+        return -1;
+    }
+}
+
+void PtyProcess::kill()
+{
+    // 已回收的 pid 可能被复用，不能再发信号
+    if (pid_ > 0 && !exited_) {
+        ::kill(pid_, SIGKILL);
+    }
+}
+
+void PtyProcess::setStatus(int status)
+{
+    exited_ = true;
+    if (WIFEXITED(status)) {
+        exitCode_ = WEXITSTATUS(status);
+        crashed_ = false;
+    }
+}
+
+bool PtyProcess::poll()
+{
+    if (pid_ <= 0 || exited_) {
+        return true;
+    }
+    int status = 0;
+    pid_t ret = ::waitpid(pid_, &status, WNOHANG);
+    if (ret == 0 || (ret < 0 && errno == EINTR)) {
+        return false;
+    }
+    if (ret > 0) {
+        setStatus(status);
+    } else {
+        exited_ = true;
+    }
+    return true;
+}
+
+void PtyProcess::wait(int& exitCode, bool& crashed)
+{
+    if (pid_ > 0 && !exited_) {
+        int status = 0;
+        pid_t ret;
+        do {
+            ret = ::waitpid(pid_, &status, 0);
+        } while (ret < 0 && errno == EINTR);
+        if (ret > 0) {
+            setStatus(status);
+        } else {
+            exited_ = true;
+        }
+    }
+    pid_ = -1;
+    exitCode = exitCode_;
+    crashed = crashed_;
+
+    if (master_ >= 0) {
+        ::close(master_);
+        master_ = -1;
+    }
+}
+#endif
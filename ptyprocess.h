@@ -0,0 +1,51 @@
+#ifndef PTYPROCESS_H
+#define PTYPROCESS_H
+
+#include <QProcessEnvironment>
+#include <QStringList>
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+#include <sys/types.h>
+
+// 在伪终端中运行子进程，子进程的 stdout/stderr 都是终端，
+// ninja 等工具因此启用单行原地刷新的状态输出。
+// 只负责创建、终止和回收进程，读取由调用方在 I/O 线程中驱动。
+// 主端创建时即带 O_CLOEXEC，其他线程同时启动的进程不会继承它。
+class PtyProcess
+{
+public:
+    PtyProcess() = default;
+    ~PtyProcess();
+
+public:
+    bool start(const QString& program, const QStringList& arguments, const QString& workDir,
+               const QProcessEnvironment& env);
+    int fd() const;
+    // 子进程已退出后返回 -1
+    qint64 pid() const;
+    QString errorString() const;
+    // 非阻塞读取：返回读到的字节数，0 表示暂无数据，-1 表示终端已关闭
+    qint64 read(char* buf, qint64 size);
+    void kill();
+    // 不阻塞地检查子进程是否已退出，已退出时回收
+    bool poll();
+    // 等待子进程退出并关闭终端；crashed 为 true 表示被信号终止
+    void wait(int& exitCode, bool& crashed);
+
+private:
+    void setStatus(int status);
+
+private:
+    int master_{-1};
+    pid_t pid_{-1};
+    bool exited_{};
+    int exitCode_{-1};
+    bool crashed_{true};
+    QString error_;
+
+    Q_DISABLE_COPY(PtyProcess)
+};
+#endif
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// 无锁单生产者/单消费者队列，按固定大小的块无界增长。
+// 生产者只写 tail_ 所在块，消费者只读 head_ 所在块，块内通过 written 计数发布数据。
+template <typename T, int BlockSize = 1024>
+class SpscQueue
+{
+public:
+    SpscQueue()
+    {
+        head_ = tail_ = new Block();
+    }
+
+    ~SpscQueue()
+    {
+        Block* block = head_;
+        while (block) {
+            Block* next = block->next.load(std::memory_order_relaxed);
+            delete block;
+            block = next;
+        }
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+public:
+    // 仅生产者线程调用
+    void push(T value)
+    {
+        if (writeIndex_ == BlockSize) {
+            Block* block = new Block();
+            tail_->next.store(block, std::memory_order_release);
+            tail_ = block;
+            writeIndex_ = 0;
+        }
+        tail_->items[writeIndex_] = std::move(value);
+        ++writeIndex_;
+        tail_->written.store(writeIndex_, std::memory_order_release);
+    }
+
+    // 仅消费者线程调用
+    bool pop(T& value)
+    {
+        if (readIndex_ == BlockSize) {
+            Block* next = head_->next.load(std::memory_order_acquire);
+            if (!next) {
+                return false;
+            }
+            delete head_;
+            head_ = next;
+            readIndex_ = 0;
+        }
+        if (readIndex_ >= head_->written.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(head_->items[readIndex_]);
+        ++readIndex_;
+        return true;
+    }
+
+private:
+    struct Block {
+        T items[BlockSize];
+        std::atomic<int> written{0};
+        std::atomic<Block*> next{nullptr};
+    };
+
+    // 消费者独占
+    Block* head_{};
+    int readIndex_{};
+    // 生产者独占
+    Block* tail_{};
+    int writeIndex_{};
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "terminalrenderer.h"
+
+// 超过该长度仍未结束的转义序列视为无效并丢弃
+constexpr int MAX_ESCAPE = 256;
+
+void TerminalRenderer::reset()
+{
+    line_.clear();
+    col_ = 0;
+    escape_.clear();
+}
+
+const QByteArray& TerminalRenderer::pending() const
+{
+    return line_;
+}
+
+void TerminalRenderer::put(const char* data, int size)
+{
+    if (col_ > line_.size()) {
+        line_.append(QByteArray(col_ - line_.size(), ' '));
+    }
+    int overwrite = qMin(size, line_.size() - col_);
+    line_.replace(col_, overwrite, data, size);
+    col_ += size;
+}
+
+void TerminalRenderer::feed(const QByteArray& data, QByteArray& cooked)
+{
+    const char* p = data.constData();
+    const int size = data.size();
+    int i = 0;
+    while (i < size) {
+        char c = p[i];
+
+        if (!escape_.isEmpty()) {
+            escape_.append(c);
+            ++i;
+            bool done = false;
+            if (escape_.size() == 2) {
+                done = escape_.at(1) != '[' && escape_.at(1) != ']';
+            } else if (escape_.at(1) == '[') {
+                done = c >= 0x40 && c <= 0x7e;
+            } else {
+                done = c == 0x07 || (c == '\\' && escape_.at(escape_.size() - 2) == 0x1b);
+            }
+            if (!done) {
+                if (escape_.size() > MAX_ESCAPE) {
+                    escape_.clear();
+                }
+                continue;
+            }
+
+            if (escape_.at(1) == '[') {
+                int n = escape_.mid(2, escape_.size() - 3).toInt();
+                if (c == 'K') {
+                    // 0：擦除到行尾；1：擦除到行首；2：擦除整行
+                    if (n == 0) {
+                        line_.truncate(col_);
+                    } else if (n == 1) {
+                        int end = qMin(col_ + 1, line_.size());
+                        line_.replace(0, end, QByteArray(end, ' '));
+                    } else if (n == 2) {
+                        line_.clear();
+                    }
+                } else if (c == 'G') {
+                    col_ = qMax(1, n) - 1;
+                } else if (c == 'C') {
+                    col_ += qMax(1, n);
+                } else if (c == 'D') {
+                    col_ = qMax(0, col_ - qMax(1, n));
+                } else if (c == 'm') {
+                    // 颜色原样保留给 AnsiDecoder
+                    put(escape_.constData(), escape_.size());
+                }
+            }
+            escape_.clear();
+            continue;
+        }
+
+        if (c == '\n') {
+            cooked.append(line_);
+            cooked.append('\n');
+            line_.clear();
+            col_ = 0;
+            ++i;
+        } else if (c == '\r') {
+            col_ = 0;
+            ++i;
+        } else if (c == '\b') {
+            col_ = qMax(0, col_ - 1);
+            ++i;
+        } else if (c == 0x1b) {
+            escape_.append(c);
+            ++i;
+        } else if ((static_cast<unsigned char>(c) < 0x20 && c != '\t') || c == 0x7f) {
+            // BEL 等其余控制字符不显示
+            ++i;
+        } else {
+            // 连续的可见字符一次写入
+            int j = i + 1;
+            while (j < size && (static_cast<unsigned char>(p[j]) >= 0x20 || p[j] == '\t') && p[j] != 0x7f) {
+                ++j;
+            }
+            put(p + i, j - i);
+            i = j;
+        }
+    }
+}
+
+void TerminalRenderer::finish(QByteArray& cooked)
+{
+    if (!line_.isEmpty()) {
+        cooked.append(line_);
+        cooked.append('\n');
+    }
+    reset();
+}
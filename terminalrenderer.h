@@ -0,0 +1,29 @@
+#ifndef TERMINALRENDERER_H
+#define TERMINALRENDERER_H
+
+#include <QByteArray>
+
+// 伪终端输出的简易行渲染器：处理回车覆盖（\r）、退格和擦除行（ESC[K、ESC[2K），
+// 把终端上“原地刷新”的内容还原为最终显示的行，输出以 \n 结尾的字节流交给 LineSplitter。
+// 颜色等其余转义序列原样保留，由 AnsiDecoder 处理。
+// 按字节定位光标，对 ninja/cmake 这类“回车后整行重写再擦除行尾”的刷新方式足够。
+class TerminalRenderer
+{
+public:
+    void reset();
+    // 处理一段终端输出，已换行的行追加到 cooked
+    void feed(const QByteArray& data, QByteArray& cooked);
+    void finish(QByteArray& cooked);
+    // 当前尚未换行、随时可能被覆盖的行（如 ninja 的单行状态）
+    const QByteArray& pending() const;
+
+private:
+    void put(const char* data, int size);
+
+private:
+    QByteArray line_;
+    int col_{};
+    QByteArray escape_;   // 跨读取边界的不完整转义序列
+};
+
+#endif
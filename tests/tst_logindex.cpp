@@ -0,0 +1,184 @@
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "logindex.h"
+#include "logstore.h"
+
+namespace {
+
+LogIndex::Query query(const QString& text, bool regex = false, bool caseSensitive = false)
+{
+    LogIndex::Query q;
+    q.text = text;
+    q.regex = regex;
+    q.caseSensitive = caseSensitive;
+    return q;
+}
+
+QList<QByteArray> literals(const QString& text, bool regex = true, bool caseSensitive = false)
+{
+    return LogIndex::requiredLiterals(query(text, regex, caseSensitive));
+}
+
+QString syntheticLine(int i)
+{
+    switch (i % 5) {
+    case 0:
+        return QString("[%1/50000] Building CXX object src/mod%2/file%3.cpp.o").arg(i).arg(i % 7).arg(i % 13);
+    case 1:
+        return QString("src/mod%1/file%2.cpp:%3:5: warning: unused variable 'v%4' [-Wunused-variable]")
+            .arg(i % 7)
+            .arg(i % 13)
+            .arg(i % 300)
+            .arg(i % 50);
+    case 2:
+        return QString("链接 libmod%1.so 失败：未定义的引用 Foo%2").arg(i % 7).arg(i % 11);
+    case 3:
+        return QString("ERROR: Colour mismatch in Widget%1").arg(i % 17);
+    default:
+        return QString("  note: color of widget%1 is Red").arg(i % 17);
+    }
+}
+
+// 不经过索引的逐行匹配，作为查找结果的参照
+QVector<int> bruteForce(const LogStore& store, const LogIndex::Query& q, int from, int to)
+{
+    QVector<int> out;
+    QRegularExpression re(q.text, q.caseSensitive ? QRegularExpression::NoPatternOption
+                                                  : QRegularExpression::CaseInsensitiveOption);
+    for (int line = from; line < to; ++line) {
+        QString text = store.text(line);
+        bool hit = q.regex ? re.match(text).hasMatch()
+                           : text.contains(q.text, q.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+        if (hit) {
+            out.append(line);
+        }
+    }
+    return out;
+}
+
+QVector<LogIndex::Query> searchQueries()
+{
+    return {
+        query("warning"),
+        query("Warning", false, true),
+        query("unused variable 'v12'"),
+        query("file7.cpp:"),
+        query("未定义的引用"),
+        query("未定义的引用 foo1"),
+        query("ab"),
+        query("no such text"),
+        query("colou?r", true),
+        query("warning: .*'v1[0-9]'", true),
+        query("mod(1|2)/file3", true),
+        query("^\\[\\d+/", true),
+        query("ERROR|note", true),
+        query("(?i)colour", true, true),
+        query("Widget1\\b", true, true),
+        query("libmod\\d\\.so", true),
+    };
+}
+
+}   // namespace
+
+class TestLogIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredLiterals_data();
+    void requiredLiterals();
+    void searchMatchesBruteForce_data();
+    void searchMatchesBruteForce();
+    void invalidRegex();
+};
+
+void TestLogIndex::requiredLiterals_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<bool>("regex");
+    QTest::addColumn<bool>("caseSensitive");
+    QTest::addColumn<QList<QByteArray>>("expected");
+
+    typedef QList<QByteArray> L;
+    QTest::newRow("plain") << "Error: foo" << false << true << L{"Error: foo"};
+    QTest::newRow("plain short") << "ab" << false << false << L{};
+    QTest::newRow("plain non-ascii folded") << QString("警告 abc") << false << false << L{" abc"};
+    QTest::newRow("plain non-ascii exact") << QString("警告") << false << true << L{QString("警告").toUtf8()};
+    QTest::newRow("literal regex") << "undefined reference" << true << false << L{"undefined reference"};
+    QTest::newRow("dot star") << "warning: .*unused" << true << false << L{"warning: ", "unused"};
+    QTest::newRow("optional char") << "colou?r" << true << false << L{"colo"};
+    QTest::newRow("alternation") << "foo|bar" << true << false << L{};
+    QTest::newRow("group") << "abc(def)+ghi" << true << false << L{"abc", "ghi"};
+    QTest::newRow("inline option") << "(?i)error" << true << false << L{};
+    QTest::newRow("escape class") << "\\d+ errors" << true << false << L{" errors"};
+    QTest::newRow("char class") << "[abc]xyz" << true << false << L{"xyz"};
+    QTest::newRow("repeat") << "x{2,3}yzw" << true << false << L{"yzw"};
+    QTest::newRow("escaped dot") << "a\\.b\\.c" << true << false << L{"a.b.c"};
+    QTest::newRow("quoted") << "\\Qfoo\\E" << true << false << L{};
+}
+
+void TestLogIndex::requiredLiterals()
+{
+    QFETCH(QString, pattern);
+    QFETCH(bool, regex);
+    QFETCH(bool, caseSensitive);
+    QFETCH(QList<QByteArray>, expected);
+
+    QCOMPARE(literals(pattern, regex, caseSensitive), expected);
+}
+
+void TestLogIndex::searchMatchesBruteForce_data()
+{
+    QTest::addColumn<bool>("limited");
+    // 约 2.5 MB 日志分成多个块；限制内存时旧块被转存，索引只保留常驻块
+    QTest::newRow("unlimited") << false;
+    QTest::newRow("spilled") << true;
+}
+
+void TestLogIndex::searchMatchesBruteForce()
+{
+    QFETCH(bool, limited);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LogStore store;
+    store.setSpillDir(dir.path());
+    const int count = 50000;
+    for (int i = 0; i < count; ++i) {
+        store.append(syntheticLine(i), i);
+    }
+    if (limited) {
+        store.setMemoryLimit(1);
+        QVERIFY(store.memorySize() < store.byteSize());
+    }
+
+    const QVector<QPair<int, int>> ranges = {qMakePair(0, count), qMakePair(1234, 27001), qMakePair(count - 10, count + 10)};
+    for (const LogIndex::Query& q : searchQueries()) {
+        for (const auto& range : ranges) {
+            QVector<int> found;
+            QVERIFY(store.search(q, range.first, range.second, found));
+            QVector<int> expected = bruteForce(store, q, range.first, qMin(range.second, count));
+            QVERIFY2(found == expected, qPrintable(QString("%1 [%2, %3): 索引 %4 行，逐行 %5 行")
+                                                       .arg(q.text)
+                                                       .arg(range.first)
+                                                       .arg(range.second)
+                                                       .arg(found.size())
+                                                       .arg(expected.size())));
+        }
+    }
+}
+
+void TestLogIndex::invalidRegex()
+{
+    LogStore store;
+    store.append("some text", 0);
+    QVector<int> found;
+    QVERIFY(!store.search(query("(unclosed", true), 0, 1, found));
+    QVERIFY(found.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestLogIndex)
+
+#include "tst_logindex.moc"
@@ -0,0 +1,203 @@
+#include <QtTest>
+
+#include "outputfilter.h"
+
+namespace {
+
+QString status(int finished, const QString& object)
+{
+    return QString("@@nst %1 10 1 0.5@@ Building CXX object CMakeFiles/app.dir/%2.o").arg(finished).arg(object);
+}
+
+QVector<OutputLine> feedAll(OutputFilter& filter, const QStringList& texts)
+{
+    QVector<OutputLine> out;
+    for (const QString& text : texts) {
+        OutputLine line;
+        line.text = text;
+        NinjaProgress progress;
+        filter.feed(line, out, progress);
+    }
+    filter.finish(out);
+    return out;
+}
+
+QStringList visibleText(const QVector<OutputLine>& lines)
+{
+    QStringList texts;
+    for (const OutputLine& line : lines) {
+        if (!line.hidden) {
+            texts << line.text;
+        }
+    }
+    return texts;
+}
+
+}   // namespace
+
+class TestOutputFilter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void duplicateCollapsedAcrossUnits();
+    void keyNormalizesPath();
+    void keyIgnoresColumn();
+    void keyDistinguishesLineAndMessage();
+    void notesFollowTheirDiagnostic();
+    void resetForgetsGroups();
+    void malformedStructuredLines_data();
+    void malformedStructuredLines();
+};
+
+void TestOutputFilter::duplicateCollapsedAcrossUnits()
+{
+    OutputFilter filter;
+    QVector<OutputLine> out = feedAll(filter, {
+                                                  status(1, "src/a.cpp"),
+                                                  "In file included from src/a.cpp:1:",
+                                                  "include/util.h:10:5: warning: unused parameter 'x' [-Wunused-parameter]",
+                                                  "   10 | void f(int x) {}",
+                                                  "      |            ^",
+                                                  status(2, "src/b.cpp"),
+                                                  "In file included from src/b.cpp:2:",
+                                                  "include/util.h:10:5: warning: unused parameter 'x' [-Wunused-parameter]",
+                                                  "   10 | void f(int x) {}",
+                                                  "      |            ^",
+                                                  "plain output after the duplicate",
+                                              });
+
+    // 第二次出现只保留一条隐藏的计数行，包含链和源码片段一起折叠
+    QCOMPARE(visibleText(out), QStringList({
+                                   "In file included from src/a.cpp:1:",
+                                   "include/util.h:10:5: warning: unused parameter 'x' [-Wunused-parameter]",
+                                   "   10 | void f(int x) {}",
+                                   "      |            ^",
+                                   "plain output after the duplicate",
+                               }));
+
+    QVector<OutputLine> diags;
+    for (const OutputLine& line : out) {
+        if (line.diag.severity != Diagnostic::None) {
+            diags << line;
+        }
+    }
+    QCOMPARE(diags.size(), 2);
+    QCOMPARE(diags.at(0).hidden, false);
+    QCOMPARE(diags.at(1).hidden, true);
+    QCOMPARE(diags.at(0).diag.group, diags.at(1).diag.group);
+    QCOMPARE(diags.at(0).diag.unit, QString("src/a.cpp"));
+    QCOMPARE(diags.at(1).diag.unit, QString("src/b.cpp"));
+}
+
+void TestOutputFilter::keyNormalizesPath()
+{
+    OutputFilter filter;
+    QVector<OutputLine> out = feedAll(filter, {
+                                                  "include/util.h:10:5: warning: shadowed",
+                                                  "./include/util.h:10:5: warning: shadowed",
+                                                  "src/../include/util.h:10:5: warning: shadowed",
+                                                  "include//util.h:10:5: warning: shadowed",
+                                              });
+    QCOMPARE(out.size(), 4);
+    QCOMPARE(out.at(0).hidden, false);
+    for (int i = 1; i < out.size(); ++i) {
+        QVERIFY2(out.at(i).hidden, qPrintable(out.at(i).text));
+        QCOMPARE(out.at(i).diag.group, out.at(0).diag.group);
+    }
+}
+
+void TestOutputFilter::keyIgnoresColumn()
+{
+    OutputFilter filter;
+    QVector<OutputLine> out = feedAll(filter, {
+                                                  "include/util.h:10:5: warning: shadowed",
+                                                  "include/util.h:10:9: warning: shadowed",
+                                                  "include/util.h:10: warning: shadowed",
+                                              });
+    QCOMPARE(out.size(), 3);
+    QCOMPARE(out.at(1).hidden, true);
+    QCOMPARE(out.at(2).hidden, true);
+}
+
+void TestOutputFilter::keyDistinguishesLineAndMessage()
+{
+    OutputFilter filter;
+    QVector<OutputLine> out = feedAll(filter, {
+                                                  "include/util.h:10:5: warning: shadowed",
+                                                  "include/util.h:11:5: warning: shadowed",
+                                                  "include/util.h:10:5: warning: unused",
+                                                  "include/other.h:10:5: warning: shadowed",
+                                              });
+    QCOMPARE(out.size(), 4);
+    QSet<int> groups;
+    for (const OutputLine& line : out) {
+        QCOMPARE(line.hidden, false);
+        groups.insert(line.diag.group);
+    }
+    QCOMPARE(groups.size(), 4);
+}
+
+void TestOutputFilter::notesFollowTheirDiagnostic()
+{
+    OutputFilter filter;
+    QVector<OutputLine> out = feedAll(filter, {
+                                                  "src/a.cpp:5:3: error: no matching function for call to 'g'",
+                                                  "include/util.h:3:6: note: candidate function not viable",
+                                                  "src/a.cpp:5:3: error: no matching function for call to 'g'",
+                                                  "include/util.h:3:6: note: candidate function not viable",
+                                                  "src/a.cpp:6:3: error: use of undeclared identifier 'h'",
+                                              });
+    QCOMPARE(visibleText(out), QStringList({
+                                   "src/a.cpp:5:3: error: no matching function for call to 'g'",
+                                   "include/util.h:3:6: note: candidate function not viable",
+                                   "src/a.cpp:6:3: error: use of undeclared identifier 'h'",
+                               }));
+}
+
+void TestOutputFilter::resetForgetsGroups()
+{
+    OutputFilter filter;
+    feedAll(filter, {"include/util.h:10:5: warning: shadowed"});
+    filter.reset();
+    QVector<OutputLine> out = feedAll(filter, {"include/util.h:10:5: warning: shadowed"});
+    QCOMPARE(out.size(), 1);
+    QCOMPARE(out.at(0).hidden, false);
+    QCOMPARE(out.at(0).diag.group, 0);
+}
+
+void TestOutputFilter::malformedStructuredLines_data()
+{
+    QTest::addColumn<QString>("line");
+    QTest::addColumn<int>("count");
+
+    // 任意程序都可能输出形似 JSON 的行，字段类型不符时只能忽略，不能抛出异常
+    QTest::newRow("gcc location not object") << R"([{"kind":"error","locations":[1]}])" << 1;
+    QTest::newRow("gcc caret not object") << R"([{"kind":"warning","locations":[{"caret":"x"}]}])" << 1;
+    QTest::newRow("gcc item not object") << R"([1, "kind", null])" << 0;
+    QTest::newRow("sarif location string") << R"({"runs":[{"results":[{"locations":["x"]}]}]})" << 1;
+    QTest::newRow("sarif physical string")
+        << R"({"runs":[{"results":[{"level":"error","locations":[{"physicalLocation":"x"}]}]}]})" << 1;
+    QTest::newRow("sarif region array")
+        << R"({"runs":[{"results":[{"locations":[{"physicalLocation":{"region":[1]}}],"message":"m"}]}]})" << 1;
+    QTest::newRow("sarif runs not array") << R"({"runs":{"kind":1}})" << 0;
+}
+
+void TestOutputFilter::malformedStructuredLines()
+{
+    QFETCH(QString, line);
+    QFETCH(int, count);
+
+    DiagnosticParser parser;
+    QVector<Diagnostic> diags;
+    parser.parseStructured(line, diags);
+    QCOMPARE(diags.size(), count);
+    for (const Diagnostic& diag : diags) {
+        QVERIFY(diag.file.isEmpty());
+        QCOMPARE(diag.line, 0);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestOutputFilter)
+
+#include "tst_outputfilter.moc"
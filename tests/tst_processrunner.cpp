@@ -0,0 +1,104 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtTest>
+#include <cstdio>
+#include <cstdlib>
+
+#include "processrunner.h"
+
+namespace {
+
+// 子进程输出的行数，总量（约 8 MB）远超管道缓冲区，读取一停子进程就会阻塞在写入上
+constexpr int CHATTY_LINES = 100000;
+// 等待一次运行结束的上限（毫秒）
+constexpr int RUN_TIMEOUT_MS = 60000;
+
+// 子进程模式：连续输出后报告自己的耗时，写入被阻塞的时间也计算在内
+int runChatty(int lines)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < lines; ++i) {
+        printf("chatty line %d: the quick brown fox jumps over the lazy dog, 0123456789\n", i);
+    }
+    fflush(stdout);
+    printf("elapsed %lld\n", static_cast<long long>(timer.elapsed()));
+    fflush(stdout);
+    return 0;
+}
+
+struct ChildRun {
+    qint64 childMs{-1};
+    int lines{};
+};
+
+// stallMs 期间界面线程既不处理事件也不取数据，模拟重绘或模态对话框造成的停顿
+ChildRun runChild(int stallMs)
+{
+    ChildRun result;
+    ProcessRunner runner;
+    bool finished = false;
+    QObject::connect(&runner, &ProcessRunner::sigFinished, &runner,
+                     [&finished](int, QProcess::ExitStatus) { finished = true; });
+    runner.start(QCoreApplication::applicationFilePath(), {"--chatty", QString::number(CHATTY_LINES)});
+    if (stallMs > 0) {
+        QThread::msleep(static_cast<unsigned long>(stallMs));
+    }
+
+    QVector<OutputLine> lines;
+    QElapsedTimer timer;
+    timer.start();
+    while (!finished && timer.elapsed() < RUN_TIMEOUT_MS) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+        runner.takeLines(lines);
+    }
+    runner.takeLines(lines);
+
+    result.lines = lines.size();
+    if (!lines.isEmpty() && lines.last().text.startsWith("elapsed ")) {
+        result.childMs = lines.last().text.mid(8).toLongLong();
+    }
+    return result;
+}
+
+}   // namespace
+
+class TestProcessRunner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void stalledConsumerDoesNotSlowChild();
+};
+
+void TestProcessRunner::stalledConsumerDoesNotSlowChild()
+{
+    ChildRun base = runChild(0);
+    QVERIFY2(base.childMs >= 0, "子进程没有报告耗时");
+    QCOMPARE(base.lines, CHATTY_LINES + 1);
+
+    // 停顿远长于子进程本身的运行时间：如果管道没有被持续读取，子进程至少要等到停顿结束
+    int stallMs = static_cast<int>(base.childMs * 4 + 2000);
+    ChildRun stalled = runChild(stallMs);
+    QVERIFY2(stalled.childMs >= 0, "子进程没有报告耗时");
+    QCOMPARE(stalled.lines, CHATTY_LINES + 1);
+
+    qint64 limit = base.childMs * 2 + 500;
+    QVERIFY2(stalled.childMs <= limit, qPrintable(QString("界面停顿 %1 ms 时子进程耗时 %2 ms，未停顿时 %3 ms")
+                                                      .arg(stallMs)
+                                                      .arg(stalled.childMs)
+                                                      .arg(base.childMs)));
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 3 && qstrcmp(argv[1], "--chatty") == 0) {
+        return runChatty(std::atoi(argv[2]));
+    }
+    QCoreApplication app(argc, argv);
+    TestProcessRunner test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_processrunner.moc"
@@ -0,0 +1,272 @@
+#include "timetrace.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+struct Totals {
+    qint64 us{};
+    int count{};
+};
+
+struct Aggregate {
+    QHash<QString, Totals> includes;
+    QHash<QString, Totals> templates;
+    QHash<QString, Totals> templateSets;
+    qint64 frontendUs{};
+    qint64 backendUs{};
+};
+
+// 只取 traceEvents 数组中每个事件的 name、ph、dur 和 args.detail，其余内容直接跳过。
+// 层级：1 根对象，2 traceEvents 数组，3 事件对象，4 args 对象
+class TraceHandler : public nlohmann::json_sax<json>
+{
+public:
+    explicit TraceHandler(Aggregate& agg) : agg_(agg)
+    {
+    }
+
+    qint64 compileUs() const
+    {
+        return compileUs_;
+    }
+
+    bool null() override
+    {
+        return true;
+    }
+
+    bool boolean(bool) override
+    {
+        return true;
+    }
+
+    bool number_integer(number_integer_t val) override
+    {
+        return number(static_cast<qint64>(val));
+    }
+
+    bool number_unsigned(number_unsigned_t val) override
+    {
+        return number(static_cast<qint64>(val));
+    }
+
+    bool number_float(number_float_t val, const string_t&) override
+    {
+        return number(static_cast<qint64>(val));
+    }
+
+    bool string(string_t& val) override
+    {
+        if (depth_ == 3 && inEvents_) {
+            if (key_ == "name") {
+                name_ = val;
+            } else if (key_ == "ph") {
+                ph_ = val;
+            }
+        } else if (depth_ == 4 && inArgs_ && key_ == "detail") {
+            detail_ = val;
+        }
+        return true;
+    }
+
+    bool binary(binary_t&) override
+    {
+        return true;
+    }
+
+    bool start_object(std::size_t) override
+    {
+        ++depth_;
+        if (depth_ == 3 && inEvents_) {
+            name_.clear();
+            ph_.clear();
+            detail_.clear();
+            dur_ = 0;
+        } else if (depth_ == 4 && inEvents_ && key_ == "args") {
+            inArgs_ = true;
+        }
+        return true;
+    }
+
+    bool key(string_t& val) override
+    {
+        key_ = val;
+        return true;
+    }
+
+    bool end_object() override
+    {
+        if (depth_ == 4) {
+            inArgs_ = false;
+        } else if (depth_ == 3 && inEvents_) {
+            dispatch();
+        }
+        --depth_;
+        return true;
+    }
+
+    bool start_array(std::size_t) override
+    {
+        ++depth_;
+        if (depth_ == 2 && key_ == "traceEvents") {
+            inEvents_ = true;
+        }
+        return true;
+    }
+
+    bool end_array() override
+    {
+        if (depth_ == 2) {
+            inEvents_ = false;
+        }
+        --depth_;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override
+    {
+        return false;
+    }
+
+private:
+    bool number(qint64 val)
+    {
+        if (depth_ == 3 && inEvents_ && key_ == "dur") {
+            dur_ = val;
+        }
+        return true;
+    }
+
+    void dispatch()
+    {
+        if (ph_ != "X") {
+            return;
+        }
+        auto add = [this](QHash<QString, Totals>& table, const QString& name) {
+            Totals& t = table[name];
+            t.us += dur_;
+            ++t.count;
+        };
+        if (name_ == "Source") {
+            add(agg_.includes, QDir::cleanPath(QString::fromStdString(detail_)));
+        } else if (name_ == "InstantiateClass" || name_ == "InstantiateFunction") {
+            QString detail = QString::fromStdString(detail_);
+            add(agg_.templates, detail);
+            int lt = detail.indexOf('<');
+            add(agg_.templateSets, lt > 0 ? detail.left(lt) : detail);
+        } else if (name_ == "Frontend") {
+            agg_.frontendUs += dur_;
+        } else if (name_ == "Backend") {
+            agg_.backendUs += dur_;
+        } else if (name_ == "ExecuteCompiler") {
+            compileUs_ += dur_;
+        }
+    }
+
+private:
+    Aggregate& agg_;
+    int depth_{};
+    bool inEvents_{};
+    bool inArgs_{};
+    std::string key_;
+    std::string name_;
+    std::string ph_;
+    std::string detail_;
+    qint64 dur_{};
+    qint64 compileUs_{};
+};
+
+QVector<TimeTraceItem> top(const QHash<QString, Totals>& table, int count)
+{
+    QVector<TimeTraceItem> items;
+    items.reserve(table.size());
+    for (auto it = table.constBegin(); it != table.constEnd(); ++it) {
+        TimeTraceItem item;
+        item.name = it.key();
+        item.totalUs = it->us;
+        item.count = it->count;
+        items.append(item);
+    }
+    std::sort(items.begin(), items.end(),
+              [](const TimeTraceItem& a, const TimeTraceItem& b) { return a.totalUs > b.totalUs; });
+    if (items.size() > count) {
+        items.resize(count);
+    }
+    return items;
+}
+
+}   // namespace
+
+namespace TimeTrace {
+
+QStringList findTraces(const QString& buildTree)
+{
+    // clang 把跟踪写在目标文件旁：foo.cpp.o -> foo.cpp.json，以此排除其它 json 文件
+    QStringList traces;
+    QDirIterator it(buildTree, QStringList{"*.json"}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString path = it.next();
+        QString stem = path.left(path.size() - 5);
+        if (QFile::exists(stem + ".o") || QFile::exists(stem + ".obj")) {
+            traces << path;
+        }
+    }
+    return traces;
+}
+
+TimeTraceReport aggregate(const QString& buildTree, int count)
+{
+    TimeTraceReport report;
+    Aggregate agg;
+    QHash<QString, Totals> units;
+    QDir base(buildTree);
+
+    for (const QString& path : findTraces(buildTree)) {
+#ifdef Q_OS_WIN
+        std::ifstream in(reinterpret_cast<const wchar_t*>(path.utf16()), std::ios::binary);
+#else
+        std::ifstream in(QFile::encodeName(path).constData(), std::ios::binary);
+#endif
+        if (!in.is_open()) {
+            ++report.failed;
+            continue;
+        }
+        TraceHandler handler(agg);
+        bool ok = false;
+        try {
+            ok = json::sax_parse(in, &handler);
+        } catch (const std::exception&) {
+            ok = false;
+        }
+        if (!ok) {
+            ++report.failed;
+            continue;
+        }
+        ++report.units;
+        report.bytes += QFileInfo(path).size();
+        report.compileUs += handler.compileUs();
+        Totals& unit = units[base.relativeFilePath(path.left(path.size() - 5))];
+        unit.us += handler.compileUs();
+        ++unit.count;
+    }
+
+    report.frontendUs = agg.frontendUs;
+    report.backendUs = agg.backendUs;
+    report.includes = top(agg.includes, count);
+    report.templates = top(agg.templates, count);
+    report.templateSets = top(agg.templateSets, count);
+    report.slowestUnits = top(units, count);
+    return report;
+}
+
+}   // namespace TimeTrace
@@ -0,0 +1,37 @@
+#ifndef TIMETRACE_H
+#define TIMETRACE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+struct TimeTraceItem {
+    QString name;
+    qint64 totalUs{};
+    int count{};
+};
+
+// 整个项目的 clang -ftime-trace 汇总，按总耗时排序
+struct TimeTraceReport {
+    int units{};
+    int failed{};   // 无法解析的跟踪文件
+    qint64 bytes{};
+    qint64 compileUs{};
+    qint64 frontendUs{};
+    qint64 backendUs{};
+    QVector<TimeTraceItem> includes;       // 头文件解析，含其嵌套包含
+    QVector<TimeTraceItem> templates;      // 单个模板实例化
+    QVector<TimeTraceItem> templateSets;   // 按模板名（去掉模板参数）合并
+    QVector<TimeTraceItem> slowestUnits;
+};
+
+// 汇总构建树中 clang 为每个编译单元生成的 .json 跟踪（与 .o/.obj 同名）。
+// 文件用 nlohmann 的 SAX 接口流式解析，几百 MB 的跟踪也不会整体载入内存。
+namespace TimeTrace {
+
+QStringList findTraces(const QString& buildTree);
+TimeTraceReport aggregate(const QString& buildTree, int top = 20);
+
+}   // namespace TimeTrace
+
+#endif
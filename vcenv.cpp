@@ -0,0 +1,98 @@
+#include "vcenv.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QProcess>
+
+namespace {
+
+struct CacheEntry {
+    QDateTime modified;
+    QProcessEnvironment env;
+};
+
+QMutex cacheMutex;
+QHash<QString, CacheEntry> cache;
+
+QProcessEnvironment parseEnvironmentOutput(const QString& output)
+{
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    QStringList lines = output.split('\n');
+
+    for (const QString& line : lines) {
+        QString trimmedLine = line.trimmed();
+        if (trimmedLine.isEmpty())
+            continue;
+
+        int equalsIndex = trimmedLine.indexOf('=');
+        if (equalsIndex > 0) {
+            QString varName = trimmedLine.left(equalsIndex).trimmed();
+            QString varValue = trimmedLine.mid(equalsIndex + 1).trimmed();
+            env.insert(varName, varValue);
+        }
+    }
+    return env;
+}
+
+}   // namespace
+
+namespace VcEnvironment {
+
+bool isCached(const QString& batFile)
+{
+    QDateTime modified = QFileInfo(batFile).lastModified();
+    QMutexLocker locker(&cacheMutex);
+    auto it = cache.constFind(batFile);
+    return it != cache.constEnd() && it->modified == modified;
+}
+
+QProcessEnvironment capture(const QString& batFile, QString* error)
+{
+    QDateTime modified = QFileInfo(batFile).lastModified();
+    {
+        QMutexLocker locker(&cacheMutex);
+        auto it = cache.constFind(batFile);
+        if (it != cache.constEnd() && it->modified == modified) {
+            return it->env;
+        }
+    }
+
+    // 不持锁执行脚本，两个线程同时捕获同一脚本时结果相同，后写入的覆盖即可
+    QProcess process;
+    process.setProgram("cmd.exe");
+    process.setArguments({"/c", "call", batFile, "&&", "set"});
+    process.start();
+
+    if (!process.waitForFinished(15000)) {
+        if (error) {
+            *error = "进程执行超时";
+        }
+        process.kill();
+        process.waitForFinished();
+        return QProcessEnvironment();
+    }
+
+    if (process.exitCode() != 0) {
+        if (error) {
+            *error = "VC环境脚本执行失败";
+        }
+        return QProcessEnvironment();
+    }
+
+    QString allOutput = QString::fromLocal8Bit(process.readAllStandardOutput());
+    if (allOutput.isEmpty()) {
+        if (error) {
+            *error = "没有获取到输出";
+        }
+        return QProcessEnvironment();
+    }
+
+    QProcessEnvironment env = parseEnvironmentOutput(allOutput);
+    QMutexLocker locker(&cacheMutex);
+    cache.insert(batFile, CacheEntry{modified, env});
+    return env;
+}
+
+}   // namespace VcEnvironment
@@ -0,0 +1,16 @@
+#ifndef VCENV_H
+#define VCENV_H
+
+#include <QProcessEnvironment>
+
+// 执行 vcvars*.bat 并捕获其设置的环境变量。
+// 一次捕获需要数秒，结果按脚本路径和修改时间缓存，可在任意线程调用。
+namespace VcEnvironment {
+
+// 失败时返回空环境，error 给出原因
+QProcessEnvironment capture(const QString& batFile, QString* error = nullptr);
+bool isCached(const QString& batFile);
+
+}   // namespace VcEnvironment
+
+#endif